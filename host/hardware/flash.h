@@ -0,0 +1,18 @@
+#ifndef HOST_HARDWARE_FLASH_H
+#define HOST_HARDWARE_FLASH_H
+
+#include "pico/stdlib.h"
+
+#define FLASH_PAGE_SIZE         256u
+#define FLASH_SECTOR_SIZE       4096u
+#define PICO_FLASH_SIZE_BYTES   (2u * 1024u * 1024u)
+
+// A flash do host é um vetor em memória, opcionalmente espelhado num arquivo
+// (sim_flash_open); XIP_BASE aponta para ele.
+extern uint8_t sim_flash[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t) sim_flash)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif
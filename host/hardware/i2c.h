@@ -0,0 +1,44 @@
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+typedef struct {
+    volatile uint32_t con;
+    volatile uint32_t tar;
+    volatile uint32_t sar;
+    uint32_t _pad0;
+    volatile uint32_t data_cmd;
+    volatile uint32_t enable;
+    volatile uint32_t status;
+    volatile uint32_t txflr;
+    volatile uint32_t raw_intr_stat;
+    volatile uint32_t clr_tx_abrt;
+} i2c_hw_t;
+
+typedef struct i2c_inst {
+    i2c_hw_t hw;
+    uint baudrate;
+} i2c_inst_t;
+
+extern i2c_inst_t sim_i2c_inst[2];
+#define i2c0 (&sim_i2c_inst[0])
+#define i2c1 (&sim_i2c_inst[1])
+
+#define I2C_IC_DATA_CMD_STOP_BITS     0x00000200u
+#define I2C_IC_DATA_CMD_RESTART_BITS  0x00000400u
+#define I2C_IC_STATUS_ACTIVITY_BITS   0x00000001u
+#define I2C_IC_STATUS_TFE_BITS        0x00000004u
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x00000040u
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate);
+static inline i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) { return &i2c->hw; }
+static inline uint i2c_hw_index(i2c_inst_t *i2c) { return i2c == i2c1 ? 1 : 0; }
+static inline uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx) {
+    return 32 + i2c_hw_index(i2c) * 2 + (is_tx ? 0 : 1);
+}
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len,
+                       bool nostop);
+
+#endif
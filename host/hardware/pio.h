@@ -0,0 +1,60 @@
+#ifndef HOST_HARDWARE_PIO_H
+#define HOST_HARDWARE_PIO_H
+
+#include "pico/stdlib.h"
+
+typedef struct {
+    volatile uint32_t clkdiv;
+    volatile uint32_t execctrl;
+    volatile uint32_t shiftctrl;
+    volatile uint32_t addr;
+    volatile uint32_t instr;
+    volatile uint32_t pinctrl;
+} pio_sm_hw_t;
+
+typedef struct {
+    volatile uint32_t ctrl;
+    volatile uint32_t fstat;
+    volatile uint32_t fdebug;
+    volatile uint32_t flevel;
+    volatile uint32_t txf[4];
+    volatile uint32_t rxf[4];
+    pio_sm_hw_t sm[4];
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+typedef struct {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+} pio_program_t;
+
+extern pio_hw_t sim_pio_hw[2];
+#define pio0 (&sim_pio_hw[0])
+#define pio1 (&sim_pio_hw[1])
+
+#define PIO_SM0_SHIFTCTRL_PULL_THRESH_LSB   25
+#define PIO_SM0_SHIFTCTRL_PULL_THRESH_BITS  0x3e000000u
+#define PIO_SM0_SHIFTCTRL_FJOIN_TX_BITS     0x40000000u
+
+static inline void hw_write_masked(volatile uint32_t *addr, uint32_t values, uint32_t mask) {
+    *addr = (*addr & ~mask) | (values & mask);
+}
+
+static inline uint pio_get_index(PIO pio) { return pio == pio1 ? 1 : 0; }
+static inline uint pio_get_dreq(PIO pio, uint sm, bool is_tx) {
+    return pio_get_index(pio) * 8 + (is_tx ? 0 : 4) + sm;
+}
+
+static inline void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {
+    hw_write_masked(&pio->ctrl, (enabled ? 1u : 0u) << sm, 1u << sm);
+}
+
+uint pio_add_program(PIO pio, const pio_program_t *program);
+void pio_sm_restart(PIO pio, uint sm);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div);
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef HOST_SSD1306_H
+#define HOST_SSD1306_H
+
+// Stand-in do driver inc/ssd1306.h para o host: mesma interface, implementada
+// em host/ssd1306_host.c sobre o modelo de I2C do simulador.
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+#define ssd1306_height              64
+#define ssd1306_width               128
+#define ssd1306_i2c_address         _u(0x3C)
+#define ssd1306_i2c_clock           400
+#define ssd1306_set_memory_mode     _u(0x20)
+#define ssd1306_set_column_address  _u(0x21)
+#define ssd1306_set_page_address    _u(0x22)
+#define ssd1306_page_height         _u(8)
+#define ssd1306_n_pages             (ssd1306_height / ssd1306_page_height)
+#define ssd1306_buffer_length       (ssd1306_n_pages * ssd1306_width)
+
+struct render_area {
+    uint8_t start_column;
+    uint8_t end_column;
+    uint8_t start_page;
+    uint8_t end_page;
+    int buffer_length;
+};
+
+void calculate_render_area_buffer_length(struct render_area *area);
+void ssd1306_send_command(uint8_t cmd);
+void ssd1306_send_command_list(uint8_t *ssd, int number);
+void ssd1306_send_buffer(uint8_t ssd[], int buffer_length);
+void ssd1306_init(void);
+void render_on_display(uint8_t *ssd, struct render_area *area);
+void ssd1306_set_pixel(uint8_t *ssd, int x, int y, bool set);
+void ssd1306_draw_char(uint8_t *ssd, int16_t x, int16_t y, uint8_t character);
+void ssd1306_draw_string(uint8_t *ssd, int16_t x, int16_t y, char *string);
+
+#endif
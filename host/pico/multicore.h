@@ -0,0 +1,14 @@
+#ifndef HOST_PICO_MULTICORE_H
+#define HOST_PICO_MULTICORE_H
+
+#include "pico/stdlib.h"
+
+// O núcleo 1 roda como uma corrotina: os núcleos se alternam nas esperas.
+void multicore_launch_core1(void (*entry)(void));
+
+// Os núcleos nunca rodam ao mesmo tempo, então o bloqueio é imediato.
+void multicore_lockout_victim_init(void);
+void multicore_lockout_start_blocking(void);
+void multicore_lockout_end_blocking(void);
+
+#endif
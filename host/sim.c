@@ -0,0 +1,1525 @@
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+
+#include "sim.h"
+#include "pico/multicore.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/pwm.h"
+#include "inc/ssd1306.h"
+#include "../inc/store.h"
+
+// ---------------------- Relógio virtual e fila de eventos ----------------------
+// Heap mínimo por instante; em empate vale a ordem de agendamento. Eventos
+// cancelados ficam no heap e são descartados pelo próprio tratador (tag).
+
+#define SIM_MAX_EVENTS 256
+
+typedef struct {
+    uint64_t time_us;
+    uint64_t seq;
+    sim_event_fn fn;
+    uint32_t arg;
+    uint32_t tag;
+} sim_event_t;
+
+static sim_event_t events[SIM_MAX_EVENTS];
+static uint event_count = 0;
+static uint64_t event_seq = 0;
+static uint64_t now_us = 0;
+static bool verbose = false;
+
+static struct {
+    uint64_t events;
+    uint64_t alarms;
+    uint64_t irqs;
+    uint64_t gpio_irqs;
+    uint64_t wakeups;
+    uint64_t led_frames;
+    uint64_t oled_transactions;
+    uint64_t oled_bytes;
+    uint64_t oled_nacks;
+    uint64_t notes;
+    uint64_t flash_programs;
+    uint64_t flash_erases;
+} stats;
+
+static struct timespec wall_start;
+
+static bool event_before(const sim_event_t *a, const sim_event_t *b) {
+    return a->time_us < b->time_us || (a->time_us == b->time_us && a->seq < b->seq);
+}
+
+void sim_schedule(uint64_t time_us, sim_event_fn fn, uint32_t arg, uint32_t tag) {
+    if (event_count == SIM_MAX_EVENTS) {
+        fprintf(stderr, "sim: fila de eventos cheia\n");
+        sim_exit(2);
+    }
+    uint i = event_count++;
+    sim_event_t ev = {time_us < now_us ? now_us : time_us, event_seq++, fn, arg, tag};
+    while (i > 0 && event_before(&ev, &events[(i - 1) / 2])) {
+        events[i] = events[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    events[i] = ev;
+}
+
+static sim_event_t event_pop(void) {
+    sim_event_t top = events[0];
+    sim_event_t last = events[--event_count];
+    uint i = 0;
+    while (true) {
+        uint child = 2 * i + 1;
+        if (child >= event_count)
+            break;
+        if (child + 1 < event_count && event_before(&events[child + 1], &events[child]))
+            child++;
+        if (!event_before(&events[child], &last))
+            break;
+        events[i] = events[child];
+        i = child;
+    }
+    events[i] = last;
+    return top;
+}
+
+/**
+ * Executa o próximo evento se ele vencer até o limite; caso contrário
+ * avança o relógio até o limite e retorna false.
+ */
+static bool run_next_event(uint64_t limit_us) {
+    if (event_count == 0 || events[0].time_us > limit_us) {
+        if (limit_us > now_us)
+            now_us = limit_us;
+        return false;
+    }
+    sim_event_t ev = event_pop();
+    // Eventos atrasados por uma operação na flash rodam no instante atual.
+    if (ev.time_us > now_us)
+        now_us = ev.time_us;
+    stats.events++;
+    ev.fn(ev.arg, ev.tag);
+    return true;
+}
+
+// ---------------------- Núcleos ----------------------
+// O núcleo 1 é uma corrotina e os núcleos só trocam de vez nas esperas.
+// Interrupções destinadas ao núcleo parado ficam pendentes e são entregues
+// quando ele volta a rodar.
+
+#define SIM_CORE1_STACK  (256 * 1024)
+#define SIM_MAX_DEFERRED 64
+
+typedef struct {
+    ucontext_t ctx;
+    bool launched;
+    bool event;                 // Registrador de evento (SEV)
+    bool interrupted;           // Interrupção atendida durante a espera
+    bool wake_on_event;
+    uint64_t wait_until;
+    struct {
+        sim_event_fn fn;
+        uint32_t arg, tag;
+    } deferred[SIM_MAX_DEFERRED];
+    uint deferred_count;
+} sim_core_t;
+
+static sim_core_t cores[2] = {{.launched = true}};
+static uint current_core = 0;
+static void (*core1_entry)(void);
+
+/** Executa fn no núcleo indicado: já, se ele estiver rodando, ou quando voltar. */
+static void sim_interrupt(uint core, sim_event_fn fn, uint32_t arg, uint32_t tag) {
+    if (core == current_core) {
+        fn(arg, tag);
+        cores[core].interrupted = true;
+        return;
+    }
+    sim_core_t *c = &cores[core];
+    if (c->deferred_count == SIM_MAX_DEFERRED) {
+        fprintf(stderr, "sim: interrupções pendentes demais no núcleo %u\n", core);
+        sim_exit(2);
+    }
+    c->deferred[c->deferred_count].fn = fn;
+    c->deferred[c->deferred_count].arg = arg;
+    c->deferred[c->deferred_count].tag = tag;
+    c->deferred_count++;
+}
+
+static bool core_runnable(const sim_core_t *c) {
+    return c->launched && (c->deferred_count > 0 || (c->wake_on_event && c->event) ||
+                           now_us >= c->wait_until);
+}
+
+static void switch_core(void) {
+    uint from = current_core;
+    current_core ^= 1;
+    swapcontext(&cores[from].ctx, &cores[current_core].ctx);
+}
+
+/**
+ * Espera do núcleo atual até o prazo ou, com wake_on_event, até um SEV ou
+ * uma interrupção. Enquanto isso roda o outro núcleo ou avança o relógio.
+ * Retorna true se o prazo foi atingido.
+ */
+static bool core_wait(uint64_t deadline, bool wake_on_event) {
+    sim_core_t *self = &cores[current_core];
+    sim_core_t *other = &cores[current_core ^ 1];
+    self->interrupted = false;
+    while (true) {
+        if (self->deferred_count > 0) {
+            uint count = self->deferred_count;
+            self->deferred_count = 0;
+            for (uint i = 0; i < count; i++)
+                self->deferred[i].fn(self->deferred[i].arg, self->deferred[i].tag);
+            if (wake_on_event)
+                return false;
+            continue;
+        }
+        if (wake_on_event && self->event) {
+            self->event = false;
+            return false;
+        }
+        // Como no WFE do Cortex-M0+, a entrada numa exceção também acorda.
+        if (wake_on_event && self->interrupted)
+            return false;
+        if (now_us >= deadline)
+            return true;
+        self->wait_until = deadline;
+        self->wake_on_event = wake_on_event;
+        if (core_runnable(other)) {
+            switch_core();
+            continue;
+        }
+        uint64_t limit = deadline;
+        if (other->launched && other->wait_until < limit)
+            limit = other->wait_until;
+        if (event_count == 0 && limit == UINT64_MAX) {
+            fprintf(stderr, "sim: firmware em espera sem eventos pendentes\n");
+            sim_exit(1);
+        }
+        run_next_event(limit);
+    }
+}
+
+static void core1_start(void) {
+    core1_entry();
+    cores[1].launched = false;
+    switch_core();
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    core1_entry = entry;
+    getcontext(&cores[1].ctx);
+    cores[1].ctx.uc_stack.ss_sp = malloc(SIM_CORE1_STACK);
+    cores[1].ctx.uc_stack.ss_size = SIM_CORE1_STACK;
+    cores[1].ctx.uc_link = NULL;
+    makecontext(&cores[1].ctx, core1_start, 0);
+    cores[1].launched = true;
+    cores[1].wait_until = 0;
+}
+
+void multicore_lockout_victim_init(void) {
+}
+
+void multicore_lockout_start_blocking(void) {
+}
+
+void multicore_lockout_end_blocking(void) {
+}
+
+uint get_core_num(void) {
+    return current_core;
+}
+
+void panic(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "sim: panic: ");
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+    sim_exit(2);
+}
+
+uint64_t time_us_64(void) {
+    return now_us;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t) now_us;
+}
+
+void sleep_us(uint64_t us) {
+    core_wait(now_us + us, false);
+}
+
+void sleep_ms(uint32_t ms) {
+    core_wait(now_us + (uint64_t) ms * 1000, false);
+}
+
+bool best_effort_wfe_or_timeout(absolute_time_t timeout) {
+    stats.wakeups++;
+    return core_wait(timeout, true);
+}
+
+void __wfe(void) {
+    stats.wakeups++;
+    core_wait(UINT64_MAX, true);
+}
+
+void __wfi(void) {
+    __wfe();
+}
+
+void __sev(void) {
+    cores[0].event = true;
+    cores[1].event = true;
+}
+
+// Interrupções só são entregues dentro das esperas, então desabilitá-las
+// não tem efeito no host.
+uint32_t save_and_disable_interrupts(void) {
+    return 0;
+}
+
+void restore_interrupts(uint32_t status) {
+    (void) status;
+}
+
+bool stdio_init_all(void) {
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+    return true;
+}
+
+// ---------------------- USB CDC ----------------------
+// O PC é um leitor que retira até cdc.rate bytes por milissegundo do FIFO de
+// saída do CDC (256 bytes, como em tusb_config.h) e os grava no arquivo da
+// opção -u. O printf do firmware, que na placa sai pela UART, vai direto
+// para a saída do simulador. A entrada vem do roteiro: como na USB, o PC
+// espera quando o FIFO de entrada está cheio, e o que falta entra a cada
+// milissegundo. A chegada gera uma interrupção no núcleo 0, que só o acorda:
+// o tud_task do laço principal encontra os bytes já no FIFO.
+#define SIM_CDC_TX_LEN 256
+#define SIM_CDC_RX_LEN 1024
+
+static struct {
+    uint8_t rx[SIM_CDC_RX_LEN];
+    uint rx_head, rx_tail;
+    uint8_t tx[SIM_CDC_TX_LEN];
+    uint tx_head, tx_tail;
+    uint rate;                          // Bytes por ms lidos pelo PC (0 = parado)
+    bool draining;                      // Leitura do PC agendada
+    FILE *out;
+    uint8_t *host;                      // Bytes do PC à espera de espaço
+    uint host_len, host_pos;
+    bool feeding;
+    uint64_t tx_bytes, rx_bytes;
+} cdc = {.rate = 1000};
+
+static void cdc_irq(uint32_t arg, uint32_t tag) {
+    (void) arg;
+    (void) tag;
+}
+
+static void cdc_feed(uint32_t arg, uint32_t tag) {
+    (void) arg;
+    (void) tag;
+    uint moved = 0;
+    while (cdc.host_pos < cdc.host_len && cdc.rx_head - cdc.rx_tail < SIM_CDC_RX_LEN) {
+        cdc.rx[cdc.rx_head++ % SIM_CDC_RX_LEN] = cdc.host[cdc.host_pos++];
+        moved++;
+    }
+    cdc.rx_bytes += moved;
+    if (moved > 0)
+        sim_interrupt(0, cdc_irq, 0, 0);
+    cdc.feeding = cdc.host_pos < cdc.host_len;
+    if (cdc.feeding)
+        sim_schedule(now_us + 1000, cdc_feed, 0, 0);
+    else
+        cdc.host_len = cdc.host_pos = 0;
+}
+
+void sim_serial_input(const uint8_t *data, uint len) {
+    cdc.host = realloc(cdc.host, cdc.host_len + len);
+    memcpy(&cdc.host[cdc.host_len], data, len);
+    cdc.host_len += len;
+    if (!cdc.feeding) {
+        cdc.feeding = true;
+        cdc_feed(0, 0);
+    }
+}
+
+bool tusb_init(void) {
+    return true;
+}
+
+void tud_task(void) {
+}
+
+bool tud_cdc_connected(void) {
+    return true;
+}
+
+uint32_t tud_cdc_available(void) {
+    return cdc.rx_head - cdc.rx_tail;
+}
+
+uint32_t tud_cdc_read(void *buffer, uint32_t bufsize) {
+    uint32_t n = 0;
+    while (n < bufsize && cdc.rx_tail != cdc.rx_head)
+        ((uint8_t *) buffer)[n++] = cdc.rx[cdc.rx_tail++ % SIM_CDC_RX_LEN];
+    return n;
+}
+
+uint32_t tud_cdc_write_available(void) {
+    return SIM_CDC_TX_LEN - (cdc.tx_head - cdc.tx_tail);
+}
+
+uint32_t tud_cdc_write(const void *buffer, uint32_t bufsize) {
+    uint32_t n = 0;
+    while (n < bufsize && cdc.tx_head - cdc.tx_tail < SIM_CDC_TX_LEN)
+        cdc.tx[cdc.tx_head++ % SIM_CDC_TX_LEN] = ((const uint8_t *) buffer)[n++];
+    return n;
+}
+
+static void cdc_drain(uint32_t arg, uint32_t tag) {
+    (void) arg;
+    (void) tag;
+    for (uint i = 0; i < cdc.rate && cdc.tx_tail != cdc.tx_head; i++) {
+        uint8_t byte = cdc.tx[cdc.tx_tail++ % SIM_CDC_TX_LEN];
+        if (cdc.out != NULL)
+            fputc(byte, cdc.out);
+        cdc.tx_bytes++;
+    }
+    cdc.draining = cdc.rate > 0 && cdc.tx_tail != cdc.tx_head;
+    if (cdc.draining)
+        sim_schedule(now_us + 1000, cdc_drain, 0, 0);
+}
+
+uint32_t tud_cdc_write_flush(void) {
+    if (!cdc.draining && cdc.rate > 0 && cdc.tx_tail != cdc.tx_head) {
+        cdc.draining = true;
+        sim_schedule(now_us + 1000, cdc_drain, 0, 0);
+    }
+    return cdc.tx_head - cdc.tx_tail;
+}
+
+void sim_usb_set_rate(uint bytes_per_ms) {
+    cdc.rate = bytes_per_ms;
+    tud_cdc_write_flush();
+}
+
+bool sim_usb_open(const char *path) {
+    if (path == NULL)
+        return true;
+    cdc.out = fopen(path, "wb");
+    if (cdc.out == NULL) {
+        perror(path);
+        return false;
+    }
+    return true;
+}
+
+// ---------------------- Alarmes ----------------------
+
+#define SIM_MAX_ALARMS 32
+
+typedef struct {
+    alarm_id_t id;              // 0 = livre
+    alarm_callback_t callback;
+    void *user_data;
+    uint64_t target_us;
+} sim_alarm_t;
+
+static sim_alarm_t alarms[SIM_MAX_ALARMS];
+static alarm_id_t next_alarm_id = 1;
+
+static void alarm_fire(uint32_t slot, uint32_t id) {
+    sim_alarm_t *a = &alarms[slot];
+    if (a->id != (alarm_id_t) id)
+        return;
+    // O pool de alarmes padrão atende no núcleo 0.
+    if (current_core != 0) {
+        sim_interrupt(0, alarm_fire, slot, id);
+        return;
+    }
+    stats.alarms++;
+    int64_t next = a->callback(a->id, a->user_data);
+    // O callback pode ter cancelado o próprio alarme.
+    if (a->id != (alarm_id_t) id)
+        return;
+    if (next == 0) {
+        a->id = 0;
+        return;
+    }
+    // <0: relativo ao disparo anterior; >0: relativo ao retorno do callback.
+    a->target_us = next < 0 ? a->target_us + (uint64_t)(-next) : now_us + (uint64_t) next;
+    sim_schedule(a->target_us, alarm_fire, slot, id);
+}
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data,
+                        bool fire_if_past) {
+    if (time <= now_us && !fire_if_past)
+        return 0;
+    for (uint slot = 0; slot < SIM_MAX_ALARMS; slot++) {
+        if (alarms[slot].id != 0)
+            continue;
+        alarm_id_t id = next_alarm_id++;
+        if (next_alarm_id <= 0)
+            next_alarm_id = 1;
+        alarms[slot] = (sim_alarm_t){id, callback, user_data, time < now_us ? now_us : time};
+        sim_schedule(alarms[slot].target_us, alarm_fire, slot, (uint32_t) id);
+        return id;
+    }
+    return -1;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data,
+                           bool fire_if_past) {
+    return add_alarm_at(now_us + us, callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data,
+                           bool fire_if_past) {
+    return add_alarm_at(now_us + (uint64_t) ms * 1000, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t id) {
+    if (id <= 0)
+        return false;
+    for (uint slot = 0; slot < SIM_MAX_ALARMS; slot++) {
+        if (alarms[slot].id == id) {
+            alarms[slot].id = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int64_t repeating_timer_fire(alarm_id_t id, void *user_data) {
+    struct repeating_timer *rt = user_data;
+    (void) id;
+    return rt->callback(rt) ? rt->delay_us : 0;
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback,
+                            void *user_data, struct repeating_timer *out) {
+    uint64_t delay = (uint64_t)(delay_us < 0 ? -delay_us : delay_us);
+    out->delay_us = delay_us;
+    out->callback = callback;
+    out->user_data = user_data;
+    out->alarm_id = add_alarm_in_us(delay, repeating_timer_fire, out, true);
+    return out->alarm_id > 0;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback,
+                            void *user_data, struct repeating_timer *out) {
+    return add_repeating_timer_us((int64_t) delay_ms * 1000, callback, user_data, out);
+}
+
+bool cancel_repeating_timer(struct repeating_timer *timer) {
+    bool cancelled = cancel_alarm(timer->alarm_id);
+    timer->alarm_id = 0;
+    return cancelled;
+}
+
+// ---------------------- Interrupções ----------------------
+
+#define SIM_MAX_SHARED_HANDLERS 4
+
+static struct {
+    irq_handler_t handlers[SIM_MAX_SHARED_HANDLERS];
+    uint count;
+    bool enabled;
+    uint core;                  // Núcleo que habilitou a interrupção
+} irqs[SIM_IRQ_COUNT];
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    irqs[num].handlers[0] = handler;
+    irqs[num].count = 1;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+    (void) order_priority;
+    if (irqs[num].count < SIM_MAX_SHARED_HANDLERS)
+        irqs[num].handlers[irqs[num].count++] = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    irqs[num].enabled = enabled;
+    if (enabled)
+        irqs[num].core = current_core;
+}
+
+static void irq_deliver(uint32_t num, uint32_t tag) {
+    (void) tag;
+    stats.irqs++;
+    for (uint i = 0; i < irqs[num].count; i++)
+        irqs[num].handlers[i]();
+}
+
+static void irq_raise(uint num) {
+    if (irqs[num].enabled)
+        sim_interrupt(irqs[num].core, irq_deliver, num, 0);
+}
+
+// ---------------------- GPIO ----------------------
+
+#define SIM_NUM_GPIOS 30
+
+static struct {
+    bool out;
+    bool level;
+    bool pull_up;
+    uint32_t irq_mask;
+} gpios[SIM_NUM_GPIOS];
+
+static gpio_irq_callback_t gpio_callback = NULL;
+static uint gpio_callback_core = 0;
+
+void gpio_init(uint gpio) {
+    gpios[gpio].out = false;
+    gpios[gpio].level = false;
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    gpios[gpio].out = out;
+}
+
+void gpio_put(uint gpio, bool value) {
+    gpios[gpio].level = value;
+}
+
+bool gpio_get(uint gpio) {
+    return gpios[gpio].level;
+}
+
+void gpio_pull_up(uint gpio) {
+    gpios[gpio].pull_up = true;
+    if (!gpios[gpio].out)
+        gpios[gpio].level = true;
+}
+
+void gpio_pull_down(uint gpio) {
+    gpios[gpio].pull_up = false;
+    if (!gpios[gpio].out)
+        gpios[gpio].level = false;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    (void) gpio;
+    (void) fn;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+    if (enabled)
+        gpios[gpio].irq_mask |= event_mask;
+    else
+        gpios[gpio].irq_mask &= ~event_mask;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled,
+                                        gpio_irq_callback_t callback) {
+    gpio_set_irq_enabled(gpio, event_mask, enabled);
+    gpio_callback = callback;
+    gpio_callback_core = current_core;
+    irqs[IO_IRQ_BANK0].enabled = true;
+}
+
+static void gpio_deliver(uint32_t gpio, uint32_t event) {
+    stats.gpio_irqs++;
+    gpio_callback(gpio, event);
+}
+
+void sim_set_gpio_level(uint gpio, bool level) {
+    if (gpios[gpio].level == level)
+        return;
+    gpios[gpio].level = level;
+    uint32_t event = level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    if ((gpios[gpio].irq_mask & event) && gpio_callback != NULL && irqs[IO_IRQ_BANK0].enabled)
+        sim_interrupt(gpio_callback_core, gpio_deliver, gpio, event);
+}
+
+// ---------------------- Clocks e PWM (buzzer) ----------------------
+
+static uint32_t sys_clock_hz = 125000000;
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    return clk_index == clk_sys ? sys_clock_hz : 48000000;
+}
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required) {
+    (void) required;
+    sys_clock_hz = freq_khz * 1000;
+    return true;
+}
+
+static struct {
+    uint16_t wrap;
+    uint16_t level[2];
+} pwm_slices[8];
+
+void pwm_init(uint slice_num, pwm_config *c, bool start) {
+    (void) start;
+    pwm_slices[slice_num].wrap = c->top;
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap) {
+    pwm_slices[slice_num].wrap = wrap;
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level) {
+    uint16_t *slot = &pwm_slices[pwm_gpio_to_slice_num(gpio)].level[gpio & 1];
+    if (*slot == 0 && level != 0)
+        stats.notes++;
+    *slot = level;
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled) {
+    (void) slice_num;
+    (void) enabled;
+}
+
+// ---------------------- ADC ----------------------
+
+adc_hw_t sim_adc_hw;
+
+static struct {
+    uint16_t value[5];
+    uint selected;
+    uint round_robin;
+    float clkdiv;
+    bool running;
+    uint noise;
+    uint32_t noise_state;
+} adc = {.value = {2048, 2048, 2048, 2048, 2048}};
+
+void adc_init(void) {
+}
+
+void adc_gpio_init(uint gpio) {
+    (void) gpio;
+}
+
+void adc_select_input(uint input) {
+    adc.selected = input;
+}
+
+uint adc_get_selected_input(void) {
+    return adc.selected;
+}
+
+static uint16_t adc_convert(void) {
+    int32_t value = adc.value[adc.selected];
+    if (adc.noise > 0) {
+        adc.noise_state = adc.noise_state * 1664525u + 1013904223u;
+        value += (int32_t)((adc.noise_state >> 16) % (2 * adc.noise + 1)) - (int32_t) adc.noise;
+    }
+    if (adc.round_robin != 0) {
+        do {
+            adc.selected = (adc.selected + 1) % 5;
+        } while (!(adc.round_robin & (1u << adc.selected)));
+    }
+    return (uint16_t)(value < 0 ? 0 : value > 4095 ? 4095 : value);
+}
+
+uint16_t adc_read(void) {
+    sleep_us(2);
+    return adc_convert();
+}
+
+void adc_set_round_robin(uint input_mask) {
+    adc.round_robin = input_mask;
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo,
+                    bool byte_shift) {
+    (void) en;
+    (void) dreq_en;
+    (void) dreq_thresh;
+    (void) err_in_fifo;
+    (void) byte_shift;
+}
+
+void adc_set_clkdiv(float clkdiv) {
+    adc.clkdiv = clkdiv;
+}
+
+void adc_fifo_drain(void) {
+}
+
+void sim_set_adc(uint input, uint16_t value) {
+    adc.value[input] = value;
+}
+
+void sim_set_adc_noise(uint amplitude) {
+    adc.noise = amplitude;
+}
+
+/** Período de conversão em ns: no mínimo 96 ciclos do clock de 48 MHz. */
+static uint64_t adc_period_ns(void) {
+    float cycles = adc.clkdiv + 1.0f;
+    if (cycles < 96.0f)
+        cycles = 96.0f;
+    return (uint64_t)(cycles * 1000.0f / 48.0f);
+}
+
+// ---------------------- PIO e fita de LEDs ----------------------
+// Cada máquina de estado alimenta uma fita WS2812: os bits saem do topo da
+// palavra (autopull de PULL_THRESH bits) e cada 24 bits formam um pixel GRB.
+
+#define SIM_MAX_LEDS 1024
+
+pio_hw_t sim_pio_hw[2];
+static uint8_t pio_claimed[2];
+
+typedef struct {
+    uint8_t rgb[SIM_MAX_LEDS][3];
+    uint count;
+    uint32_t shift;
+    uint shift_bits;
+    uint pixel;
+    uint64_t idle_since_us;
+} sim_strip_t;
+
+static sim_strip_t strips[2][4];
+
+uint pio_add_program(PIO pio, const pio_program_t *program) {
+    (void) pio;
+    (void) program;
+    return 0;
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+    uint index = pio_get_index(pio);
+    for (uint sm = 0; sm < 4; sm++) {
+        if (!(pio_claimed[index] & (1u << sm))) {
+            pio_claimed[index] |= 1u << sm;
+            return (int) sm;
+        }
+    }
+    if (required) {
+        fprintf(stderr, "sim: nenhuma máquina de estado livre\n");
+        sim_exit(2);
+    }
+    return -1;
+}
+
+void pio_sm_restart(PIO pio, uint sm) {
+    sim_strip_t *s = &strips[pio_get_index(pio)][sm];
+    s->shift = 0;
+    s->shift_bits = 0;
+}
+
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div) {
+    pio->sm[sm].clkdiv = (uint32_t)(div * 65536.0f);
+}
+
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm) {
+    (void) pio;
+    (void) sm;
+    return true;
+}
+
+static uint pio_pull_bits(uint pio_index, uint sm) {
+    uint bits = (sim_pio_hw[pio_index].sm[sm].shiftctrl & PIO_SM0_SHIFTCTRL_PULL_THRESH_BITS) >>
+                PIO_SM0_SHIFTCTRL_PULL_THRESH_LSB;
+    return bits == 0 ? 32 : bits;
+}
+
+static void strip_push_word(uint pio_index, uint sm, uint32_t word) {
+    sim_strip_t *s = &strips[pio_index][sm];
+    uint bits = pio_pull_bits(pio_index, sm);
+    for (uint i = 0; i < bits; i++) {
+        s->shift = (s->shift << 1) | ((word >> (31 - i)) & 1);
+        if (++s->shift_bits == 24) {
+            if (s->pixel < SIM_MAX_LEDS) {
+                s->rgb[s->pixel][0] = (uint8_t)(s->shift >> 8);
+                s->rgb[s->pixel][1] = (uint8_t)(s->shift >> 16);
+                s->rgb[s->pixel][2] = (uint8_t) s->shift;
+                s->pixel++;
+                if (s->pixel > s->count)
+                    s->count = s->pixel;
+            }
+            s->shift = 0;
+            s->shift_bits = 0;
+        }
+    }
+}
+
+// ---------------------- I2C e modelo do SSD1306 ----------------------
+
+i2c_inst_t sim_i2c_inst[2];
+
+static struct {
+    uint8_t ram[ssd1306_n_pages][ssd1306_width];
+    uint8_t col_start, col_end, page_start, page_end;
+    uint8_t col, page;
+    uint8_t cmd[8];
+    uint cmd_len;
+    bool on;
+    bool dirty;
+    char last_text[ssd1306_n_pages][ssd1306_width / 8 + 2];
+} oled = {.col_end = ssd1306_width - 1, .page_end = ssd1306_n_pages - 1};
+
+static struct {
+    uint8_t bytes[2048];
+    uint len;
+} i2c_txn[2];
+static bool i2c_nack_next = false;
+static bool i2c_nack_late = false;
+
+void sim_i2c_nack(bool late) {
+    i2c_nack_next = true;
+    i2c_nack_late = late;
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    return i2c_set_baudrate(i2c, baudrate);
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    // Os bytes são entregues no fim do DMA: o FIFO de TX nunca fica com sobra.
+    i2c->hw.status = I2C_IC_STATUS_TFE_BITS;
+    return baudrate;
+}
+
+static uint oled_cmd_args(uint8_t cmd) {
+    switch (cmd) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+    case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+    case 0x21: case 0x22: case 0xA3:
+        return 2;
+    case 0x29: case 0x2A:
+        return 5;
+    case 0x26: case 0x27:
+        return 6;
+    default:
+        return 0;
+    }
+}
+
+static void oled_command(uint8_t byte) {
+    oled.cmd[oled.cmd_len++] = byte;
+    if (oled.cmd_len < 1 + oled_cmd_args(oled.cmd[0]))
+        return;
+    oled.cmd_len = 0;
+    switch (oled.cmd[0]) {
+    case 0x21:
+        oled.col_start = oled.col = oled.cmd[1] & 0x7f;
+        oled.col_end = oled.cmd[2] & 0x7f;
+        break;
+    case 0x22:
+        oled.page_start = oled.page = oled.cmd[1] & 0x07;
+        oled.page_end = oled.cmd[2] & 0x07;
+        break;
+    case 0xAE:
+        oled.on = false;
+        break;
+    case 0xAF:
+        oled.on = true;
+        break;
+    }
+}
+
+static void oled_data(uint8_t byte) {
+    oled.ram[oled.page][oled.col] = byte;
+    oled.dirty = true;
+    if (oled.col++ >= oled.col_end) {
+        oled.col = oled.col_start;
+        if (oled.page++ >= oled.page_end)
+            oled.page = oled.page_start;
+    }
+}
+
+/** Transação completa (START ... STOP) destinada ao display. */
+static void oled_transaction(const uint8_t *bytes, uint len) {
+    stats.oled_transactions++;
+    stats.oled_bytes += len + 1;
+    uint i = 0;
+    while (i < len) {
+        uint8_t control = bytes[i++];
+        bool data = control & 0x40;
+        if (control & 0x80) {
+            // Co = 1: um único byte e depois outro byte de controle.
+            if (i < len)
+                data ? oled_data(bytes[i]) : oled_command(bytes[i]);
+            i++;
+        } else {
+            for (; i < len; i++)
+                data ? oled_data(bytes[i]) : oled_command(bytes[i]);
+        }
+    }
+}
+
+static void i2c_deliver(uint index, uint8_t addr, const uint8_t *bytes, uint len) {
+    (void) index;
+    if (addr == ssd1306_i2c_address)
+        oled_transaction(bytes, len);
+}
+
+static void i2c_push_cmd(uint index, uint32_t word) {
+    if (i2c_txn[index].len < sizeof(i2c_txn[index].bytes))
+        i2c_txn[index].bytes[i2c_txn[index].len++] = (uint8_t) word;
+    if (word & I2C_IC_DATA_CMD_STOP_BITS) {
+        i2c_deliver(index, (uint8_t) sim_i2c_inst[index].hw.tar, i2c_txn[index].bytes,
+                    i2c_txn[index].len);
+        i2c_txn[index].len = 0;
+    }
+}
+
+static uint64_t i2c_byte_ns(uint index) {
+    uint baud = sim_i2c_inst[index].baudrate ? sim_i2c_inst[index].baudrate : 100000;
+    return 9ull * 1000000000ull / baud;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len,
+                       bool nostop) {
+    uint index = i2c_hw_index(i2c);
+    sleep_us((i2c_byte_ns(index) * (len + 1) + 999) / 1000);
+    if (!nostop)
+        i2c_deliver(index, addr, src, (uint) len);
+    return (int) len;
+}
+
+// ---------------------- DMA ----------------------
+// A transferência inteira é feita no instante de conclusão, calculado pelo
+// ritmo do DREQ do periférico; endereços avançam como no hardware.
+
+static struct {
+    bool claimed;
+    bool busy;
+    bool irq0_enabled, irq1_enabled;
+    bool irq0_status, irq1_status;
+    dma_channel_config cfg;
+    uintptr_t read_addr, write_addr;
+    uint32_t count;
+    uint32_t gen;               // Invalida conclusões agendadas
+    bool waiting_adc;
+} dma[NUM_DMA_CHANNELS];
+
+int dma_claim_unused_channel(bool required) {
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ch++) {
+        if (!dma[ch].claimed) {
+            dma[ch].claimed = true;
+            return (int) ch;
+        }
+    }
+    if (required) {
+        fprintf(stderr, "sim: nenhum canal de DMA livre\n");
+        sim_exit(2);
+    }
+    return -1;
+}
+
+void dma_channel_unclaim(uint channel) {
+    dma[channel].claimed = false;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    dma_channel_config c = {DMA_SIZE_32, true, false, false, 0, DREQ_FORCE, (int) channel};
+    return c;
+}
+
+static uint64_t dma_duration_ns(uint ch) {
+    uint dreq = dma[ch].cfg.dreq;
+    uint64_t count = dma[ch].count;
+    if (dreq < 16)
+        return count * pio_pull_bits(dreq / 8, dreq % 4) * 1250;
+    if (dreq >= DREQ_I2C0_TX && dreq < DREQ_I2C0_TX + 4)
+        return count * i2c_byte_ns((dreq - DREQ_I2C0_TX) / 2);
+    if (dreq == DREQ_ADC)
+        return count * adc_period_ns();
+    return 0;
+}
+
+static void dma_complete(uint32_t ch, uint32_t gen);
+
+static void dma_schedule(uint ch) {
+    uint64_t ns = dma_duration_ns(ch);
+    sim_schedule(now_us + (ns + 999) / 1000, dma_complete, ch, dma[ch].gen);
+}
+
+static void dma_trigger(uint ch) {
+    // No lugar da leitura de IC_CLR_TX_ABRT, que o substituto não vê, um
+    // novo envio ao I2C limpa o abort.
+    uintptr_t wr = dma[ch].write_addr;
+    if (wr >= (uintptr_t) sim_i2c_inst && wr < (uintptr_t)(sim_i2c_inst + 2))
+        sim_i2c_inst[(wr - (uintptr_t) sim_i2c_inst) / sizeof(i2c_inst_t)].hw.raw_intr_stat &=
+            ~I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+    dma[ch].gen++;
+    dma[ch].busy = true;
+    dma[ch].waiting_adc = dma[ch].cfg.dreq == DREQ_ADC && !adc.running;
+    if (!dma[ch].waiting_adc)
+        dma_schedule(ch);
+}
+
+static uintptr_t dma_step(uintptr_t addr, uint size, bool increment, uint ring_bits) {
+    if (!increment)
+        return addr;
+    if (ring_bits == 0)
+        return addr + size;
+    uintptr_t mask = ((uintptr_t) 1 << ring_bits) - 1;
+    return (addr & ~mask) | ((addr + size) & mask);
+}
+
+static void dma_complete(uint32_t ch, uint32_t gen) {
+    if (dma[ch].gen != gen || !dma[ch].busy)
+        return;
+    dma_channel_config *c = &dma[ch].cfg;
+    uint size = 1u << c->size;
+    uintptr_t rd = dma[ch].read_addr, wr = dma[ch].write_addr;
+    uint read_ring = c->ring_write ? 0 : c->ring_size_bits;
+    uint write_ring = c->ring_write ? c->ring_size_bits : 0;
+
+    int pio_index = -1, pio_sm = 0, i2c_index = -1;
+    if (wr >= (uintptr_t) sim_pio_hw && wr < (uintptr_t)(sim_pio_hw + 2)) {
+        pio_index = (int)((wr - (uintptr_t) sim_pio_hw) / sizeof(pio_hw_t));
+        pio_sm = (int)((wr - (uintptr_t) sim_pio_hw[pio_index].txf) / sizeof(uint32_t));
+    } else if (wr >= (uintptr_t) sim_i2c_inst && wr < (uintptr_t)(sim_i2c_inst + 2)) {
+        i2c_index = (int)((wr - (uintptr_t) sim_i2c_inst) / sizeof(i2c_inst_t));
+    }
+    bool from_adc = rd == (uintptr_t) &sim_adc_hw.fifo;
+    if (pio_index >= 0) {
+        // Após o tempo de reset (>= 50 us em nível baixo) a fita volta ao pixel 0.
+        sim_strip_t *s = &strips[pio_index][pio_sm];
+        uint64_t start_us = now_us - (dma_duration_ns(ch) + 999) / 1000;
+        if (start_us >= s->idle_since_us + 50) {
+            s->pixel = 0;
+            s->shift_bits = 0;
+        }
+    }
+
+    // Com NACK, metade das palavras sai antes do abort; no tardio, todas
+    // menos as 8 últimas, que o controlador descarta depois do DMA.
+    bool nack = i2c_index >= 0 && i2c_nack_next;
+    uint32_t count = dma[ch].count;
+    if (nack)
+        count = !i2c_nack_late ? count / 2 : count > 8 ? count - 8 : 0;
+    for (uint32_t n = 0; n < count; n++) {
+        uint32_t word;
+        if (from_adc)
+            word = adc_convert();
+        else if (size == 1)
+            word = *(const uint8_t *) rd;
+        else if (size == 2)
+            word = *(const uint16_t *) rd;
+        else
+            word = *(const uint32_t *) rd;
+
+        if (pio_index >= 0) {
+            // Escritas estreitas são replicadas nas faixas do barramento.
+            if (size == 1)
+                word *= 0x01010101u;
+            else if (size == 2)
+                word *= 0x00010001u;
+            strip_push_word((uint) pio_index, (uint) pio_sm, word);
+        } else if (i2c_index >= 0) {
+            i2c_push_cmd((uint) i2c_index, word);
+        } else if (size == 1) {
+            *(uint8_t *) wr = (uint8_t) word;
+        } else if (size == 2) {
+            *(uint16_t *) wr = (uint16_t) word;
+        } else {
+            *(uint32_t *) wr = word;
+        }
+        rd = dma_step(rd, size, c->read_increment, read_ring);
+        wr = dma_step(wr, size, c->write_increment, write_ring);
+    }
+    dma[ch].read_addr = rd;
+    dma[ch].write_addr = wr;
+    if (nack) {
+        // O controlador encerra a transação com STOP; o canal fica parado,
+        // a não ser que o NACK tenha vindo depois do fim do DMA.
+        i2c_nack_next = false;
+        if (i2c_txn[i2c_index].len > 0)
+            i2c_deliver((uint) i2c_index, (uint8_t) sim_i2c_inst[i2c_index].hw.tar,
+                        i2c_txn[i2c_index].bytes, i2c_txn[i2c_index].len);
+        i2c_txn[i2c_index].len = 0;
+        sim_i2c_inst[i2c_index].hw.raw_intr_stat |= I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+        stats.oled_nacks++;
+        if (!i2c_nack_late)
+            return;
+    }
+    dma[ch].busy = false;
+
+    if (pio_index >= 0) {
+        strips[pio_index][pio_sm].idle_since_us = now_us;
+        stats.led_frames++;
+    }
+    if (i2c_index >= 0 && verbose)
+        sim_dump_oled_text(NULL);
+
+    if (dma[ch].irq0_enabled) {
+        dma[ch].irq0_status = true;
+        irq_raise(DMA_IRQ_0);
+    }
+    if (dma[ch].irq1_enabled) {
+        dma[ch].irq1_status = true;
+        irq_raise(DMA_IRQ_1);
+    }
+    if (c->chain_to != (int) ch)
+        dma_trigger((uint) c->chain_to);
+}
+
+void adc_run(bool run) {
+    adc.running = run;
+    if (!run)
+        return;
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ch++) {
+        if (dma[ch].busy && dma[ch].waiting_adc) {
+            dma[ch].waiting_adc = false;
+            dma_schedule(ch);
+        }
+    }
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config,
+                           volatile void *write_addr, const volatile void *read_addr,
+                           uint transfer_count, bool trigger) {
+    dma[channel].cfg = *config;
+    dma[channel].write_addr = (uintptr_t) write_addr;
+    dma[channel].read_addr = (uintptr_t) read_addr;
+    dma[channel].count = transfer_count;
+    if (trigger)
+        dma_trigger(channel);
+}
+
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger) {
+    dma[channel].cfg = *config;
+    if (trigger)
+        dma_trigger(channel);
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger) {
+    dma[channel].read_addr = (uintptr_t) read_addr;
+    if (trigger)
+        dma_trigger(channel);
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger) {
+    dma[channel].write_addr = (uintptr_t) write_addr;
+    if (trigger)
+        dma_trigger(channel);
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger) {
+    dma[channel].count = trans_count;
+    if (trigger)
+        dma_trigger(channel);
+}
+
+void dma_channel_start(uint channel) {
+    dma_trigger(channel);
+}
+
+void dma_start_channel_mask(uint32_t chan_mask) {
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ch++)
+        if (chan_mask & (1u << ch))
+            dma_trigger(ch);
+}
+
+void dma_channel_abort(uint channel) {
+    dma[channel].gen++;
+    dma[channel].busy = false;
+}
+
+bool dma_channel_is_busy(uint channel) {
+    return dma[channel].busy;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+    while (dma[channel].busy)
+        core_wait(event_count > 0 ? events[0].time_us : UINT64_MAX, false);
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+    dma[channel].irq0_enabled = enabled;
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled) {
+    dma[channel].irq1_enabled = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel) {
+    return dma[channel].irq0_status;
+}
+
+bool dma_channel_get_irq1_status(uint channel) {
+    return dma[channel].irq1_status;
+}
+
+void dma_channel_acknowledge_irq0(uint channel) {
+    dma[channel].irq0_status = false;
+}
+
+void dma_channel_acknowledge_irq1(uint channel) {
+    dma[channel].irq1_status = false;
+}
+
+// ---------------------- Flash ----------------------
+// Apagar leva o setor a 0xFF e programar só limpa bits, como na NOR. As
+// operações custam o tempo típico da W25Q16 e, como no Pico (interrupções
+// desligadas e o outro núcleo bloqueado), nada roda enquanto isso.
+
+#define SIM_FLASH_PROGRAM_US  800
+#define SIM_FLASH_ERASE_US    45000
+
+uint8_t sim_flash[PICO_FLASH_SIZE_BYTES];
+static FILE *flash_file = NULL;
+
+bool sim_flash_open(const char *path) {
+    memset(sim_flash, 0xFF, sizeof(sim_flash));
+    if (path == NULL)
+        return true;
+    flash_file = fopen(path, "r+b");
+    if (flash_file != NULL) {
+        size_t n = fread(sim_flash, 1, sizeof(sim_flash), flash_file);
+        (void) n;
+    } else {
+        flash_file = fopen(path, "w+b");
+        if (flash_file == NULL) {
+            perror(path);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void flash_sync(uint32_t offset, size_t count) {
+    if (flash_file == NULL)
+        return;
+    // Arquivos curtos são completados com 0xFF até o trecho alterado.
+    fseek(flash_file, 0, SEEK_END);
+    long size = ftell(flash_file);
+    if (size < (long) offset)
+        fwrite(&sim_flash[size], 1, offset - (size_t) size, flash_file);
+    fseek(flash_file, (long) offset, SEEK_SET);
+    fwrite(&sim_flash[offset], 1, count, flash_file);
+    fflush(flash_file);
+}
+
+static void flash_check(uint32_t offset, size_t count, uint32_t align) {
+    if (offset % align != 0 || count % align != 0 || offset + count > PICO_FLASH_SIZE_BYTES) {
+        fprintf(stderr, "sim: acesso à flash desalinhado ou fora da faixa (0x%x, %zu)\n",
+                offset, count);
+        sim_exit(2);
+    }
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    flash_check(flash_offs, count, FLASH_SECTOR_SIZE);
+    memset(&sim_flash[flash_offs], 0xFF, count);
+    flash_sync(flash_offs, count);
+    stats.flash_erases += count / FLASH_SECTOR_SIZE;
+    now_us += (count / FLASH_SECTOR_SIZE) * SIM_FLASH_ERASE_US;
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    flash_check(flash_offs, count, FLASH_PAGE_SIZE);
+    for (size_t i = 0; i < count; i++)
+        sim_flash[flash_offs + i] &= data[i];
+    flash_sync(flash_offs, count);
+    stats.flash_programs += count / FLASH_PAGE_SIZE;
+    now_us += (count / FLASH_PAGE_SIZE) * SIM_FLASH_PROGRAM_US;
+}
+
+static void print_store_record(const store_record_t *record, uint32_t sector,
+                               uint32_t generation, void *ctx) {
+    FILE *out = ctx;
+    fprintf(out, "  setor %u ger %u  chave %u:", sector, generation, record->key);
+    if (record->len == 0)
+        fprintf(out, " (removida)");
+    for (uint i = 0; i < record->len; i++)
+        fprintf(out, " %02x", record->data[i]);
+    fputc('\n', out);
+}
+
+// ---------------------- Saída ----------------------
+
+void sim_set_verbose(bool on) {
+    verbose = on;
+}
+
+static uint led_row = 5;
+
+void sim_set_led_row(uint leds) {
+    led_row = leds;
+}
+
+static void print_time(FILE *out) {
+    uint64_t s = now_us / 1000000;
+    fprintf(out, "[%llud %02llu:%02llu:%02llu.%03llu]", (unsigned long long)(s / 86400),
+            (unsigned long long)(s / 3600 % 24), (unsigned long long)(s / 60 % 60),
+            (unsigned long long)(s % 60), (unsigned long long)(now_us / 1000 % 1000));
+}
+
+/** Cor dominante de um LED como uma letra (ponto = apagado). */
+static char led_char(const uint8_t *rgb) {
+    uint r = rgb[0], g = rgb[1], b = rgb[2];
+    uint max = r > g ? (r > b ? r : b) : (g > b ? g : b);
+    if (max == 0)
+        return '.';
+    bool hr = r * 2 > max, hg = g * 2 > max, hb = b * 2 > max;
+    if (hr && hg && hb)
+        return 'W';
+    if (hr && hg)
+        return 'Y';
+    if (hr && hb)
+        return 'M';
+    if (hg && hb)
+        return 'C';
+    return hr ? 'R' : hg ? 'G' : 'B';
+}
+
+void sim_dump_leds(FILE *out) {
+    for (uint p = 0; p < 2; p++) {
+        for (uint sm = 0; sm < 4; sm++) {
+            sim_strip_t *s = &strips[p][sm];
+            if (s->count == 0)
+                continue;
+            print_time(out);
+            fprintf(out, " LEDs pio%u/sm%u:\n", p, sm);
+            // led_row LEDs por linha, na ordem da fita; o índice 0 fica na
+            // linha de baixo.
+            uint rows = (s->count + led_row - 1) / led_row;
+            for (uint r = 0; r < rows; r++) {
+                fputs("  ", out);
+                for (uint c = 0; c < led_row; c++) {
+                    uint i = (rows - 1 - r) * led_row + c;
+                    fputc(i < s->count ? led_char(s->rgb[i]) : ' ', out);
+                    fputc(' ', out);
+                }
+                fputc('\n', out);
+            }
+        }
+    }
+}
+
+static bool glyph_match(uint page, uint x, const uint8_t *glyph) {
+    for (uint i = 0; i < 8; i++) {
+        uint8_t col = x + i < ssd1306_width ? oled.ram[page][x + i] : 0;
+        if (col != glyph[i])
+            return false;
+    }
+    return true;
+}
+
+/** Reconhece o texto de uma página comparando colunas com a fonte do stand-in. */
+static void oled_page_text(uint page, char *line, uint size) {
+    uint n = 0, blank = 0;
+    uint x = 0;
+    while (x < ssd1306_width && n + 1 < size) {
+        uint g;
+        for (g = 1; g < SIM_FONT_GLYPHS; g++)
+            if (glyph_match(page, x, sim_font[g]))
+                break;
+        if (g < SIM_FONT_GLYPHS) {
+            line[n++] = sim_font_chars[g];
+            blank = 0;
+            x += 8;
+        } else if (oled.ram[page][x] == 0) {
+            if (++blank == 8) {
+                line[n++] = ' ';
+                blank = 0;
+            }
+            x++;
+        } else {
+            line[n++] = '?';
+            blank = 0;
+            while (x < ssd1306_width && oled.ram[page][x] != 0)
+                x++;
+        }
+    }
+    while (n > 0 && line[n - 1] == ' ')
+        n--;
+    line[n] = '\0';
+}
+
+/**
+ * Imprime o texto do OLED. Com out == NULL, imprime em stdout apenas se
+ * mudou desde a última impressão (modo verbose).
+ */
+void sim_dump_oled_text(FILE *out) {
+    if (out == NULL && !oled.dirty)
+        return;
+    oled.dirty = false;
+    char text[ssd1306_n_pages][ssd1306_width / 8 + 2];
+    for (uint p = 0; p < ssd1306_n_pages; p++)
+        oled_page_text(p, text[p], sizeof(text[p]));
+    if (out == NULL) {
+        if (memcmp(text, oled.last_text, sizeof(text)) == 0)
+            return;
+        out = stdout;
+    }
+    memcpy(oled.last_text, text, sizeof(text));
+    print_time(out);
+    fputs(" OLED:\n", out);
+    for (uint p = 0; p < ssd1306_n_pages; p++)
+        if (text[p][0] != '\0')
+            fprintf(out, "  |%s\n", text[p]);
+}
+
+void sim_dump_oled_pixels(FILE *out) {
+    print_time(out);
+    fputs(" OLED (pixels):\n", out);
+    // Duas linhas de pixels por linha de texto.
+    for (uint y = 0; y < ssd1306_height; y += 2) {
+        fputs("  |", out);
+        for (uint x = 0; x < ssd1306_width; x++) {
+            bool top = oled.ram[y / 8][x] & (1u << (y % 8));
+            bool bottom = oled.ram[y / 8][x] & (1u << (y % 8 + 1));
+            fputc(top && bottom ? ':' : top ? '\'' : bottom ? '.' : ' ', out);
+        }
+        fputs("|\n", out);
+    }
+}
+
+void sim_dump_stats(FILE *out) {
+    struct timespec wall_now;
+    clock_gettime(CLOCK_MONOTONIC, &wall_now);
+    double wall_s = (double)(wall_now.tv_sec - wall_start.tv_sec) +
+                    (double)(wall_now.tv_nsec - wall_start.tv_nsec) / 1e9;
+    double virtual_s = (double) now_us / 1e6;
+    print_time(out);
+    fprintf(out, " tempo real %.3f s (%.0fx)\n", wall_s, wall_s > 0 ? virtual_s / wall_s : 0.0);
+    fprintf(out, "  eventos %llu, alarmes %llu, IRQs %llu (GPIO %llu), despertares %llu\n",
+            (unsigned long long) stats.events, (unsigned long long) stats.alarms,
+            (unsigned long long) stats.irqs, (unsigned long long) stats.gpio_irqs,
+            (unsigned long long) stats.wakeups);
+    fprintf(out, "  quadros de LED %llu, transações OLED %llu (%llu bytes), notas %llu\n",
+            (unsigned long long) stats.led_frames, (unsigned long long) stats.oled_transactions,
+            (unsigned long long) stats.oled_bytes, (unsigned long long) stats.notes);
+    if (stats.oled_nacks > 0)
+        fprintf(out, "  OLED: %llu NACKs\n", (unsigned long long) stats.oled_nacks);
+    fprintf(out, "  flash: %llu páginas gravadas, %llu setores apagados\n",
+            (unsigned long long) stats.flash_programs, (unsigned long long) stats.flash_erases);
+    fprintf(out, "  USB: %llu bytes enviados, %llu recebidos\n",
+            (unsigned long long) cdc.tx_bytes, (unsigned long long) cdc.rx_bytes);
+}
+
+void sim_dump_store(FILE *out) {
+    const uint8_t *region = &sim_flash[PICO_FLASH_SIZE_BYTES - STORE_SECTORS * FLASH_SECTOR_SIZE];
+    print_time(out);
+    fprintf(out, " armazenamento:\n");
+    uint32_t bad = store_decode(region, STORE_SECTORS, print_store_record, out);
+    if (bad > 0)
+        fprintf(out, "  %u registros inválidos\n", bad);
+}
+
+void sim_exit(int code) {
+    fflush(stdout);
+    sim_dump_stats(stderr);
+    exit(code);
+}
@@ -0,0 +1,70 @@
+#ifndef HOST_SIM_H
+#define HOST_SIM_H
+
+// ---------------------- Simulador de host ----------------------
+// Relógio virtual e periféricos sem cabeça (LEDs, OLED, ADC, botões, buzzer)
+// sob os stand-ins do pico-sdk. O tempo só avança quando o firmware espera
+// (sleep, WFE, escrita bloqueante), então horas simuladas custam milissegundos.
+// Os dois núcleos se alternam nessas esperas.
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+
+typedef void (*sim_event_fn)(uint32_t arg, uint32_t tag);
+
+/** Agenda um evento do modelo para o instante absoluto indicado (us). */
+void sim_schedule(uint64_t time_us, sim_event_fn fn, uint32_t arg, uint32_t tag);
+
+/** Nível de um pino de entrada (botões com pull-up: pressionado = false). */
+void sim_set_gpio_level(uint gpio, bool level);
+
+/** Valor bruto de uma entrada do ADC (0-4095) e amplitude do ruído somado. */
+void sim_set_adc(uint input, uint16_t value);
+void sim_set_adc_noise(uint amplitude);
+
+/** Bytes recebidos pela serial; o firmware é avisado por interrupção. */
+void sim_serial_input(const uint8_t *data, uint len);
+
+/**
+ * Bytes por milissegundo que o PC lê da USB (0 = para de ler). O que ele lê
+ * vai para o arquivo aberto por sim_usb_open(), se houver.
+ */
+void sim_usb_set_rate(uint bytes_per_ms);
+bool sim_usb_open(const char *path);
+
+/**
+ * O próximo envio por DMA ao I2C recebe NACK no meio: metade das palavras
+ * chega ao barramento, o controlador aborta e o DMA fica parado. Com late,
+ * o NACK vem nos últimos bytes, que ainda estavam no FIFO quando o DMA
+ * terminou: o canal conclui e só o controlador registra o abort.
+ */
+void sim_i2c_nack(bool late);
+
+/** Impressão do estado dos periféricos. */
+void sim_set_led_row(uint leds);          // LEDs por linha em sim_dump_leds (padrão 5)
+void sim_dump_leds(FILE *out);
+void sim_dump_oled_text(FILE *out);
+void sim_dump_oled_pixels(FILE *out);
+void sim_dump_stats(FILE *out);
+
+/**
+ * Espelha a flash num arquivo: carrega o conteúdo (se existir) e regrava
+ * cada setor alterado. Sem arquivo, a flash começa apagada a cada execução.
+ */
+bool sim_flash_open(const char *path);
+
+/** Decodifica o armazenamento do firmware (inc/store.h) no fim da flash. */
+void sim_dump_store(FILE *out);
+
+/** Com verbose, cada mudança no texto do OLED é impressa com o horário. */
+void sim_set_verbose(bool verbose);
+
+/** Encerra a simulação com um resumo. */
+void sim_exit(int code);
+
+// Fonte do stand-in do driver, usada também para reconhecer o texto no OLED.
+#define SIM_FONT_GLYPHS 52
+extern const uint8_t sim_font[SIM_FONT_GLYPHS][8];
+extern const char sim_font_chars[SIM_FONT_GLYPHS + 1];
+
+#endif
@@ -0,0 +1,381 @@
+// O firmware é compilado com -Dmain=bob_main; aqui main volta a ser o ponto
+// de entrada do simulador.
+#undef main
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "../inc/link.h"
+
+// ---------------------- Roteiro de entrada ----------------------
+// Cada linha: <tempo> <comando> [argumentos]. O tempo é absoluto ou, com '+',
+// relativo à linha anterior (nunca volta no tempo); sufixos us, ms (padrão),
+// s, m, h e d.
+//
+//   press [main|erase|<gpio>] [duração]   toque (padrão: main, 80ms)
+//   hold / release [main|erase|<gpio>]    segura / solta
+//   left|right|up|down [duração]          inclina o joystick (padrão 100ms)
+//   joy <x> <y>                           valores brutos do ADC (0-4095)
+//   noise <amplitude>                     ruído somado às leituras do ADC
+//   bounce <n>                            bordas extras a cada borda de botão
+//   dump | screen | stats                 texto do OLED e LEDs / pixels / contadores
+//   store                                 registros do armazenamento na flash
+//   serial <texto>                        bytes enviados pela serial (\n = nova linha)
+//   send <hex>                            quadro do protocolo: tipo e carga em hexa
+//   sendfile <arquivo>                    bytes de um arquivo (por exemplo, de bobctl -e)
+//   usb <bytes/ms>                        ritmo de leitura do PC (0 = para de ler)
+//   nack [fim]                            NACK no meio (ou nos bytes finais) do próximo envio ao OLED
+//   end                                   encerra
+
+#define SIM_BUTTON_PIN  6
+#define SIM_ERASE_PIN   5
+#define SIM_ADC_X       1               // GPIO 27
+#define SIM_ADC_Y       0               // GPIO 26
+#define SIM_ADC_CENTER  2048
+#define SIM_BOUNCE_US   300
+
+int bob_main(void);
+
+typedef enum {
+    CMD_PRESS, CMD_HOLD, CMD_RELEASE, CMD_LEFT, CMD_RIGHT, CMD_UP, CMD_DOWN,
+    CMD_JOY, CMD_NOISE, CMD_BOUNCE, CMD_DUMP, CMD_SCREEN, CMD_STATS, CMD_STORE, CMD_SERIAL,
+    CMD_SEND, CMD_SENDFILE, CMD_USB, CMD_NACK, CMD_END
+} sim_cmd_t;
+
+static const char *cmd_names[] = {
+    "press", "hold", "release", "left", "right", "up", "down",
+    "joy", "noise", "bounce", "dump", "screen", "stats", "store", "serial",
+    "send", "sendfile", "usb", "nack", "end"
+};
+
+typedef struct {
+    uint64_t time_us;
+    sim_cmd_t cmd;
+    uint32_t a, b;
+    char *text;                     // serial, send, sendfile
+} script_line_t;
+
+#define SIM_MAX_LINES 4096
+
+static script_line_t lines[SIM_MAX_LINES];
+static uint line_count = 0;
+static uint bounce_edges = 0;
+static uint8_t send_seq = 0;
+
+static bool parse_time(const char *s, uint64_t *us) {
+    char *end;
+    double value = strtod(s, &end);
+    if (end == s || value < 0)
+        return false;
+    double scale = 1000.0;
+    if (strcmp(end, "us") == 0)
+        scale = 1.0;
+    else if (strcmp(end, "ms") == 0 || *end == '\0')
+        scale = 1000.0;
+    else if (strcmp(end, "s") == 0)
+        scale = 1e6;
+    else if (strcmp(end, "m") == 0)
+        scale = 60e6;
+    else if (strcmp(end, "h") == 0)
+        scale = 3600e6;
+    else if (strcmp(end, "d") == 0)
+        scale = 86400e6;
+    else
+        return false;
+    *us = (uint64_t)(value * scale);
+    return true;
+}
+
+static bool parse_pin(const char *s, uint32_t *pin) {
+    if (s == NULL || strcmp(s, "main") == 0)
+        *pin = SIM_BUTTON_PIN;
+    else if (strcmp(s, "erase") == 0)
+        *pin = SIM_ERASE_PIN;
+    else if (s[0] != '\0' && strspn(s, "0123456789") == strlen(s))
+        *pin = (uint32_t) atoi(s);
+    else
+        return false;
+    return true;
+}
+
+static void button_edge(uint32_t pin, uint32_t level) {
+    sim_set_gpio_level(pin, level);
+}
+
+/** Borda de botão, seguida de repiques que terminam no nível final. */
+static void button_set(uint32_t pin, bool pressed) {
+    bool level = !pressed;
+    uint64_t t = time_us_64();
+    sim_set_gpio_level(pin, level);
+    for (uint i = 0; i < bounce_edges; i++) {
+        t += SIM_BOUNCE_US;
+        sim_schedule(t, button_edge, pin, (i % 2 == 0) ? level : !level);
+    }
+    if (bounce_edges % 2 == 1)
+        sim_schedule(t + SIM_BOUNCE_US, button_edge, pin, level);
+}
+
+static void button_release(uint32_t pin, uint32_t tag) {
+    (void) tag;
+    button_set(pin, false);
+}
+
+static void joystick_set(uint32_t x, uint32_t y) {
+    sim_set_adc(SIM_ADC_X, (uint16_t) x);
+    sim_set_adc(SIM_ADC_Y, (uint16_t) y);
+}
+
+static void run_line(uint32_t index, uint32_t tag) {
+    (void) tag;
+    const script_line_t *l = &lines[index];
+    uint64_t now = time_us_64();
+    // As linhas são agendadas uma a uma para não lotar a fila de eventos.
+    if (index + 1 < line_count)
+        sim_schedule(lines[index + 1].time_us, run_line, index + 1, 0);
+    switch (l->cmd) {
+    case CMD_PRESS:
+        button_set(l->a, true);
+        sim_schedule(now + l->b, button_release, l->a, 0);
+        break;
+    case CMD_HOLD:
+        button_set(l->a, true);
+        break;
+    case CMD_RELEASE:
+        button_set(l->a, false);
+        break;
+    case CMD_LEFT:
+    case CMD_RIGHT:
+    case CMD_UP:
+    case CMD_DOWN: {
+        // Mesma convenção do firmware: X alto é "Esquerda", Y baixo é "Cima".
+        uint32_t x = l->cmd == CMD_LEFT ? 4095 : l->cmd == CMD_RIGHT ? 0 : SIM_ADC_CENTER;
+        uint32_t y = l->cmd == CMD_DOWN ? 4095 : l->cmd == CMD_UP ? 0 : SIM_ADC_CENTER;
+        joystick_set(x, y);
+        sim_schedule(now + l->a, joystick_set, SIM_ADC_CENTER, SIM_ADC_CENTER);
+        break;
+    }
+    case CMD_JOY:
+        joystick_set(l->a, l->b);
+        break;
+    case CMD_NOISE:
+        sim_set_adc_noise(l->a);
+        break;
+    case CMD_BOUNCE:
+        bounce_edges = l->a;
+        break;
+    case CMD_DUMP:
+        sim_dump_oled_text(stdout);
+        sim_dump_leds(stdout);
+        break;
+    case CMD_SCREEN:
+        sim_dump_oled_pixels(stdout);
+        break;
+    case CMD_STATS:
+        sim_dump_stats(stdout);
+        break;
+    case CMD_STORE:
+        sim_dump_store(stdout);
+        break;
+    case CMD_SERIAL:
+        sim_serial_input((const uint8_t *) l->text, l->a);
+        break;
+    case CMD_SEND: {
+        uint8_t wire[LINK_WIRE_MAX];
+        uint32_t n = link_encode((uint8_t) l->text[0], send_seq++, l->text + 1, l->a - 1, wire);
+        sim_serial_input(wire, n);
+        break;
+    }
+    case CMD_SENDFILE:
+        sim_serial_input((const uint8_t *) l->text, l->a);
+        break;
+    case CMD_USB:
+        sim_usb_set_rate(l->a);
+        break;
+    case CMD_NACK:
+        sim_i2c_nack(l->a);
+        break;
+    case CMD_END:
+        sim_exit(0);
+        break;
+    }
+}
+
+static bool parse_line(char *text, uint64_t *time_us, script_line_t *l) {
+    char *tokens[4] = {NULL};
+    uint n = 0;
+    for (char *t = strtok(text, " \t\r\n"); t != NULL && n < 4; t = strtok(NULL, " \t\r\n"))
+        tokens[n++] = t;
+    if (n < 2)
+        return false;
+
+    uint64_t t;
+    bool relative = tokens[0][0] == '+';
+    if (!parse_time(tokens[0] + relative, &t))
+        return false;
+    t = relative ? *time_us + t : t;
+    if (t < *time_us)
+        return false;
+    *time_us = l->time_us = t;
+
+    uint cmd;
+    for (cmd = 0; cmd < count_of(cmd_names); cmd++)
+        if (strcmp(tokens[1], cmd_names[cmd]) == 0)
+            break;
+    if (cmd == count_of(cmd_names))
+        return false;
+    l->cmd = (sim_cmd_t) cmd;
+    l->a = l->b = 0;
+
+    uint64_t duration;
+    switch (l->cmd) {
+    case CMD_PRESS:
+        // O primeiro argumento pode ser o botão ou já a duração.
+        if (tokens[2] != NULL && parse_pin(tokens[2], &l->a)) {
+            tokens[2] = tokens[3];
+        } else {
+            l->a = SIM_BUTTON_PIN;
+        }
+        if (tokens[2] != NULL && !parse_time(tokens[2], &duration))
+            return false;
+        l->b = tokens[2] != NULL ? (uint32_t) duration : 80000;
+        return true;
+    case CMD_HOLD:
+    case CMD_RELEASE:
+        return parse_pin(tokens[2], &l->a);
+    case CMD_LEFT:
+    case CMD_RIGHT:
+    case CMD_UP:
+    case CMD_DOWN:
+        if (tokens[2] != NULL && !parse_time(tokens[2], &duration))
+            return false;
+        l->a = tokens[2] != NULL ? (uint32_t) duration : 100000;
+        return true;
+    case CMD_JOY:
+        if (tokens[3] == NULL)
+            return false;
+        l->a = (uint32_t) atoi(tokens[2]);
+        l->b = (uint32_t) atoi(tokens[3]);
+        return true;
+    case CMD_NACK:
+        if (tokens[2] != NULL && strcmp(tokens[2], "fim") != 0)
+            return false;
+        l->a = tokens[2] != NULL;
+        return true;
+    case CMD_NOISE:
+    case CMD_BOUNCE:
+    case CMD_USB:
+        if (tokens[2] == NULL)
+            return false;
+        l->a = (uint32_t) atoi(tokens[2]);
+        return true;
+    case CMD_SERIAL: {
+        if (tokens[2] == NULL)
+            return false;
+        char *text = strdup(tokens[2]);
+        uint32_t len = 0;
+        for (const char *p = tokens[2]; *p != '\0'; p++) {
+            if (p[0] == '\\' && p[1] == 'n') {
+                text[len++] = '\n';
+                p++;
+            } else {
+                text[len++] = *p;
+            }
+        }
+        l->text = text;
+        l->a = len;
+        return true;
+    }
+    case CMD_SEND: {
+        size_t digits = tokens[2] != NULL ? strlen(tokens[2]) : 0;
+        if (digits < 2 || digits % 2 != 0 || digits / 2 > LINK_PAYLOAD_MAX + 1)
+            return false;
+        char *bytes = malloc(digits / 2);
+        for (size_t i = 0; i < digits / 2; i++) {
+            char pair[3] = {tokens[2][2 * i], tokens[2][2 * i + 1], '\0'};
+            char *end;
+            bytes[i] = (char) strtoul(pair, &end, 16);
+            if (*end != '\0') {
+                free(bytes);
+                return false;
+            }
+        }
+        l->text = bytes;
+        l->a = (uint32_t)(digits / 2);
+        return true;
+    }
+    case CMD_SENDFILE: {
+        // O arquivo é lido ao carregar o roteiro.
+        FILE *f = tokens[2] != NULL ? fopen(tokens[2], "rb") : NULL;
+        if (f == NULL)
+            return false;
+        fseek(f, 0, SEEK_END);
+        long size = ftell(f);
+        rewind(f);
+        l->text = malloc(size > 0 ? (size_t) size : 1);
+        l->a = (uint32_t) fread(l->text, 1, (size_t) size, f);
+        fclose(f);
+        return true;
+    }
+    default:
+        return true;
+    }
+}
+
+static bool load_script(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return false;
+    }
+    char text[256];
+    uint64_t time_us = 0;
+    uint number = 0;
+    while (fgets(text, sizeof(text), f) != NULL) {
+        number++;
+        char *comment = strchr(text, '#');
+        if (comment != NULL)
+            *comment = '\0';
+        char *p = text;
+        while (isspace((unsigned char) *p))
+            p++;
+        if (*p == '\0')
+            continue;
+        if (line_count == SIM_MAX_LINES || !parse_line(p, &time_us, &lines[line_count])) {
+            fprintf(stderr, "%s:%u: linha inválida\n", path, number);
+            fclose(f);
+            return false;
+        }
+        line_count++;
+    }
+    fclose(f);
+    if (line_count > 0)
+        sim_schedule(lines[0].time_us, run_line, 0, 0);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const char *script = NULL;
+    const char *flash = NULL;
+    const char *usb = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0)
+            sim_set_verbose(true);
+        else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+            flash = argv[++i];
+        else if (strcmp(argv[i], "-u") == 0 && i + 1 < argc)
+            usb = argv[++i];
+        else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+            sim_set_led_row((uint) atoi(argv[++i]));
+        else
+            script = argv[i];
+    }
+    if (script == NULL) {
+        fprintf(stderr, "uso: %s [-v] [-f flash.bin] [-u usb.bin] [-l leds/linha] roteiro.sim\n", argv[0]);
+        return 2;
+    }
+    if (!load_script(script) || !sim_flash_open(flash) || !sim_usb_open(usb))
+        return 2;
+    return bob_main();
+}
@@ -0,0 +1,138 @@
+#include <ctype.h>
+#include <string.h>
+
+#include "sim.h"
+#include "inc/ssd1306.h"
+
+// ---------------------- Stand-in do driver SSD1306 ----------------------
+// Mesma interface do driver da BitDogLab: comandos com o byte de controle
+// 0x80, dados com 0x40, sempre no i2c1. Caracteres ocupam células de 8x8.
+
+const char sim_font_chars[SIM_FONT_GLYPHS + 1] =
+    " ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789:%-.!?/()<>,=+'";
+
+// Fonte 5x7 em colunas (bit 0 no topo), completada com colunas vazias.
+const uint8_t sim_font[SIM_FONT_GLYPHS][8] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, // A
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, // B
+    {0x3E, 0x41, 0x41, 0x41, 0x22}, // C
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, // D
+    {0x7F, 0x49, 0x49, 0x49, 0x41}, // E
+    {0x7F, 0x09, 0x09, 0x09, 0x01}, // F
+    {0x3E, 0x41, 0x49, 0x49, 0x7A}, // G
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, // H
+    {0x00, 0x41, 0x7F, 0x41, 0x00}, // I
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, // J
+    {0x7F, 0x08, 0x14, 0x22, 0x41}, // K
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, // L
+    {0x7F, 0x02, 0x0C, 0x02, 0x7F}, // M
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, // N
+    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // O
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, // P
+    {0x3E, 0x41, 0x51, 0x21, 0x5E}, // Q
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, // R
+    {0x46, 0x49, 0x49, 0x49, 0x31}, // S
+    {0x01, 0x01, 0x7F, 0x01, 0x01}, // T
+    {0x3F, 0x40, 0x40, 0x40, 0x3F}, // U
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, // V
+    {0x3F, 0x40, 0x38, 0x40, 0x3F}, // W
+    {0x63, 0x14, 0x08, 0x14, 0x63}, // X
+    {0x07, 0x08, 0x70, 0x08, 0x07}, // Y
+    {0x61, 0x51, 0x49, 0x45, 0x43}, // Z
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, // 0
+    {0x00, 0x42, 0x7F, 0x40, 0x00}, // 1
+    {0x42, 0x61, 0x51, 0x49, 0x46}, // 2
+    {0x21, 0x41, 0x45, 0x4B, 0x31}, // 3
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, // 4
+    {0x27, 0x45, 0x45, 0x45, 0x39}, // 5
+    {0x3C, 0x4A, 0x49, 0x49, 0x30}, // 6
+    {0x01, 0x71, 0x09, 0x05, 0x03}, // 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, // 8
+    {0x06, 0x49, 0x49, 0x29, 0x1E}, // 9
+    {0x00, 0x36, 0x36, 0x00, 0x00}, // :
+    {0x23, 0x13, 0x08, 0x64, 0x62}, // %
+    {0x08, 0x08, 0x08, 0x08, 0x08}, // -
+    {0x00, 0x60, 0x60, 0x00, 0x00}, // .
+    {0x00, 0x00, 0x5F, 0x00, 0x00}, // !
+    {0x02, 0x01, 0x51, 0x09, 0x06}, // ?
+    {0x20, 0x10, 0x08, 0x04, 0x02}, // /
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, // (
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, // )
+    {0x08, 0x14, 0x22, 0x41, 0x00}, // <
+    {0x00, 0x41, 0x22, 0x14, 0x08}, // >
+    {0x00, 0x50, 0x30, 0x00, 0x00}, // ,
+    {0x14, 0x14, 0x14, 0x14, 0x14}, // =
+    {0x08, 0x08, 0x3E, 0x08, 0x08}, // +
+    {0x00, 0x05, 0x03, 0x00, 0x00}, // '
+};
+
+static int font_index(uint8_t character) {
+    const char *p = character ? strchr(sim_font_chars, toupper(character)) : NULL;
+    return p ? (int)(p - sim_font_chars) : 0;
+}
+
+void calculate_render_area_buffer_length(struct render_area *area) {
+    area->buffer_length = (area->end_column - area->start_column + 1) *
+                          (area->end_page - area->start_page + 1);
+}
+
+void ssd1306_send_command(uint8_t cmd) {
+    uint8_t buf[2] = {0x80, cmd};
+    i2c_write_blocking(i2c1, ssd1306_i2c_address, buf, 2, false);
+}
+
+void ssd1306_send_command_list(uint8_t *ssd, int number) {
+    for (int i = 0; i < number; i++)
+        ssd1306_send_command(ssd[i]);
+}
+
+void ssd1306_send_buffer(uint8_t ssd[], int buffer_length) {
+    uint8_t temp[ssd1306_buffer_length + 1];
+    temp[0] = 0x40;
+    memcpy(temp + 1, ssd, (size_t) buffer_length);
+    i2c_write_blocking(i2c1, ssd1306_i2c_address, temp, (size_t) buffer_length + 1, false);
+}
+
+void ssd1306_init(void) {
+    uint8_t commands[] = {
+        0xAE, ssd1306_set_memory_mode, 0x00, 0x40, 0xA1, 0xA8, ssd1306_height - 1,
+        0xC8, 0xD3, 0x00, 0xDA, 0x12, 0xD5, 0x80, 0xD9, 0xF1, 0xDB, 0x30,
+        0x81, 0xFF, 0xA4, 0xA6, 0x8D, 0x14, 0x2E, 0xAF
+    };
+    ssd1306_send_command_list(commands, count_of(commands));
+}
+
+void render_on_display(uint8_t *ssd, struct render_area *area) {
+    uint8_t commands[] = {
+        ssd1306_set_column_address, area->start_column, area->end_column,
+        ssd1306_set_page_address, area->start_page, area->end_page
+    };
+    ssd1306_send_command_list(commands, count_of(commands));
+    ssd1306_send_buffer(ssd, area->buffer_length);
+}
+
+void ssd1306_set_pixel(uint8_t *ssd, int x, int y, bool set) {
+    if (x < 0 || x >= ssd1306_width || y < 0 || y >= ssd1306_height)
+        return;
+    uint8_t *byte = &ssd[(y / 8) * ssd1306_width + x];
+    if (set)
+        *byte |= 1u << (y % 8);
+    else
+        *byte &= ~(1u << (y % 8));
+}
+
+void ssd1306_draw_char(uint8_t *ssd, int16_t x, int16_t y, uint8_t character) {
+    if (x > ssd1306_width - 8 || y > ssd1306_height - 8)
+        return;
+    memcpy(&ssd[(y / 8) * ssd1306_width + x], sim_font[font_index(character)], 8);
+}
+
+void ssd1306_draw_string(uint8_t *ssd, int16_t x, int16_t y, char *string) {
+    if (x > ssd1306_width - 8 || y > ssd1306_height - 8)
+        return;
+    while (*string) {
+        ssd1306_draw_char(ssd, x, y, (uint8_t) *string++);
+        x += 8;
+    }
+}
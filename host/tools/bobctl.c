@@ -0,0 +1,379 @@
+// Ferramenta do PC para o protocolo de inc/link.h. Decodifica o fluxo da USB
+// (arquivo ou entrada padrão), monta quadros de comando e compara perfis.
+//
+//   gcc -Iinc host/tools/bobctl.c inc/link.c inc/prof.c inc/hist.c -o bobctl
+//   bobctl [-x traco.bin] [-H hist.csv] [fluxo.bin]
+//                                         imprime telemetria, ACKs, perfil e
+//                                         histórico; -x salva o traço recebido
+//                                         e -H o histórico em CSV
+//   bobctl -e <comando> [args] > cmd.bin  codifica um comando
+//   bobctl -c base.bin novo.bin           compara o último perfil de cada fluxo
+//
+// Comandos: rate <ms>, stat <atributo> <valor>, input <input_t>,
+// action <menu> <item>, profile [reset], trace record|stop|play,
+// replay <traco.bin> (carrega o traço e o reproduz), history.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hist.h"
+#include "link.h"
+#include "prof.h"
+
+static const char *stat_names[] = {"fome", "higiene", "energia", "diversao"};
+static const char *result_names[] = {"ok", "comando invalido", "argumento invalido", "ocupado"};
+
+static void print_telemetry(const link_frame_t *f) {
+    const uint8_t *p = f->payload;
+    if (f->len < LINK_TM_LEN) {
+        printf("telemetria curta (%u bytes)\n", f->len);
+        return;
+    }
+    printf("[%lu ms] #%u", (unsigned long) link_get32(&p[LINK_TM_UPTIME]), f->seq);
+    for (int i = 0; i < 4; i++) {
+        uint16_t q8 = link_get16(&p[LINK_TM_STATS + 2 * i]);
+        printf(" %s %u.%02u", stat_names[i], q8 >> 8, (q8 & 0xFF) * 100 / 256);
+    }
+    const uint8_t *ui = &p[LINK_TM_UI];
+    printf(" | passo %lu ms, tela %u menu %u item %u dif %u, tabuleiro %07lx/%07lx%s%s"
+           " | descartados %lu, erros %lu\n",
+           (unsigned long) link_get32(&p[LINK_TM_NEXT_STEP]), ui[0], ui[1], ui[2], ui[3],
+           (unsigned long) link_get32(&p[LINK_TM_BOARD]),
+           (unsigned long) link_get32(&p[LINK_TM_BOARD + 4]),
+           p[LINK_TM_FLAGS] & 1 ? " ocioso" : "", p[LINK_TM_FLAGS] & 2 ? " vez-do-jogador" : "",
+           (unsigned long) link_get32(&p[LINK_TM_TX_DROPPED]),
+           (unsigned long) link_get32(&p[LINK_TM_RX_ERRORS]));
+}
+
+// Os trechos do perfil chegam um por quadro e são impressos juntos.
+#define MAX_SECTIONS    32
+#define REGRESSION_PCT  10          // Piora da média que conta como regressão
+
+typedef struct {
+    prof_section_t sections[MAX_SECTIONS];
+    char names[MAX_SECTIONS][LINK_PAYLOAD_MAX - LINK_PF_NAME + 1];
+    int count;
+} profile_t;
+
+static profile_t incoming;          // Perfil sendo recebido
+static profile_t last_profile;      // Último perfil completo do fluxo
+static bool quiet = false;
+
+static void flush_profile(void) {
+    if (incoming.count == 0)
+        return;
+    if (!quiet)
+        prof_print(incoming.sections, incoming.count);
+    last_profile = incoming;
+    for (int i = 0; i < last_profile.count; i++)
+        last_profile.sections[i].name = last_profile.names[i];
+    incoming.count = 0;
+}
+
+static void add_profile(const link_frame_t *f) {
+    const uint8_t *p = f->payload;
+    if (f->len <= LINK_PF_NAME || incoming.count == MAX_SECTIONS) {
+        printf("perfil invalido (%u bytes)\n", f->len);
+        return;
+    }
+    char *name = incoming.names[incoming.count];
+    memset(name, 0, sizeof(incoming.names[0]));
+    memcpy(name, &p[LINK_PF_NAME], f->len - LINK_PF_NAME);
+    prof_section_t *s = &incoming.sections[incoming.count++];
+    *s = (prof_section_t){.name = name};
+    s->count = link_get32(&p[LINK_PF_COUNT]);
+    s->min_us = link_get32(&p[LINK_PF_MIN]);
+    s->max_us = link_get32(&p[LINK_PF_MAX]);
+    s->total_us = link_get32(&p[LINK_PF_TOTAL]) | (uint64_t) link_get32(&p[LINK_PF_TOTAL + 4]) << 32;
+    for (int b = 0; b < PROF_BUCKETS; b++)
+        s->hist[b] = link_get32(&p[LINK_PF_HIST + 4 * b]);
+}
+
+// Trechos do traço enviados pelo firmware (LINK_TRACE), montados pela posição.
+static uint8_t trace[65536];
+static uint32_t trace_len = 0;
+
+static void add_trace(const link_frame_t *f, const char *path) {
+    if (f->len < 2)
+        return;
+    uint32_t offset = link_get16(f->payload), n = f->len - 2u;
+    if (offset + n > sizeof(trace))
+        return;
+    memcpy(&trace[offset], &f->payload[2], n);
+    if (offset + n > trace_len)
+        trace_len = offset + n;
+    if (n > 0)
+        return;
+    // O trecho vazio fecha o traço.
+    FILE *out = path != NULL ? fopen(path, "wb") : NULL;
+    if (out != NULL) {
+        fwrite(trace, 1, offset, out);
+        fclose(out);
+    }
+    printf("traco: %lu bytes%s%s\n", (unsigned long) offset, out != NULL ? " salvos em " : "",
+           out != NULL ? path : "");
+    trace_len = 0;
+}
+
+// Imagem do histórico (LINK_HISTORY), montada como o traço.
+static uint8_t history[65536];
+
+static void add_history(const link_frame_t *f, const char *path) {
+    static const char *kind_names[] = {"decaimento", "mudanca", "reinicio", "?"};
+    if (f->len < 2)
+        return;
+    uint32_t offset = link_get16(f->payload), n = f->len - 2u;
+    if (offset + n > sizeof(history))
+        return;
+    memcpy(&history[offset], &f->payload[2], n);
+    if (n > 0)
+        return;
+    hist_t hist;
+    uint32_t export_s;
+    if (!hist_open(&hist, history, offset, &export_s)) {
+        printf("historico invalido (%lu bytes)\n", (unsigned long) offset);
+        return;
+    }
+    FILE *out = path != NULL ? fopen(path, "w") : NULL;
+    hist_cursor_t cursor;
+    hist_cursor_start(&hist, &cursor);
+    if (out != NULL) {
+        fprintf(out, "tempo_s,tipo,fome,higiene,energia,diversao\n");
+        fprintf(out, "%lu,inicio", (unsigned long) cursor.state.time_s);
+        for (int i = 0; i < PET_STATS; i++)
+            fprintf(out, ",%u", cursor.state.values[i]);
+        fputc('\n', out);
+    }
+    hist_entry_t entry;
+    unsigned long records = 0;
+    while (hist_cursor_next(&hist, &cursor, &entry) > 0) {
+        records++;
+        if (out == NULL)
+            continue;
+        fprintf(out, "%lu,%s", (unsigned long) entry.state.time_s, kind_names[entry.kind]);
+        for (int i = 0; i < PET_STATS; i++)
+            fprintf(out, ",%u", entry.state.values[i]);
+        fputc('\n', out);
+    }
+    if (out != NULL)
+        fclose(out);
+    printf("historico: %lu bytes, %lu registros de %lu s a %lu s (exportado em %lu s):",
+           (unsigned long) offset, records, (unsigned long) hist.first.time_s,
+           (unsigned long) cursor.state.time_s, (unsigned long) export_s);
+    for (int i = 0; i < PET_STATS; i++)
+        printf(" %s %u", stat_names[i], cursor.state.values[i]);
+    printf("%s%s\n", out != NULL ? ", salvo em " : "", out != NULL ? path : "");
+}
+
+static int decode(FILE *in, const char *trace_path, const char *history_path) {
+    link_parser_t parser = {0};
+    link_frame_t frame;
+    unsigned long frames = 0, errors = 0, gaps = 0;
+    int last_seq = -1;
+    int c;
+    while ((c = fgetc(in)) != EOF) {
+        int result = link_parse(&parser, (uint8_t) c, &frame);
+        if (result < 0)
+            errors++;
+        if (result <= 0)
+            continue;
+        frames++;
+        // Um salto na sequência conta os quadros descartados pelo firmware.
+        if (last_seq >= 0 && frame.seq != (uint8_t)(last_seq + 1))
+            gaps += (uint8_t)(frame.seq - last_seq - 1);
+        last_seq = frame.seq;
+        if (frame.type != LINK_PROFILE)
+            flush_profile();
+        if (quiet && frame.type != LINK_PROFILE)
+            continue;
+        switch (frame.type) {
+        case LINK_TELEMETRY:
+            print_telemetry(&frame);
+            break;
+        case LINK_PROFILE:
+            add_profile(&frame);
+            break;
+        case LINK_TRACE:
+            add_trace(&frame, trace_path);
+            break;
+        case LINK_HISTORY:
+            add_history(&frame, history_path);
+            break;
+        case LINK_TEXT:
+            printf("%.*s\n", frame.len, (const char *) frame.payload);
+            break;
+        case LINK_ACK:
+            if (frame.len >= 3)
+                printf("ack #%u: comando 0x%02x seq %u, %s\n", frame.seq, frame.payload[1],
+                       frame.payload[0],
+                       frame.payload[2] < 4 ? result_names[frame.payload[2]] : "?");
+            break;
+        default:
+            printf("quadro 0x%02x #%u (%u bytes)\n", frame.type, frame.seq, frame.len);
+            break;
+        }
+    }
+    flush_profile();
+    if (!quiet)
+        printf("%lu quadros, %lu perdidos pela sequencia, %lu trechos invalidos\n",
+           frames, gaps, errors);
+    return 0;
+}
+
+/**
+ * Quadros que carregam um traço em trechos e o reproduzem.
+ */
+static int encode_replay(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return 1;
+    }
+    uint8_t data[65536];
+    uint32_t len = (uint32_t) fread(data, 1, sizeof(data), f);
+    fclose(f);
+    uint8_t payload[LINK_PAYLOAD_MAX], wire[LINK_WIRE_MAX];
+    uint8_t seq = 0;
+    for (uint32_t offset = 0; offset < len; offset += LINK_TRACE_CHUNK) {
+        uint32_t n = len - offset < LINK_TRACE_CHUNK ? len - offset : LINK_TRACE_CHUNK;
+        payload[0] = LINK_TRACE_LOAD;
+        link_put16(&payload[1], (uint16_t) offset);
+        memcpy(&payload[3], &data[offset], n);
+        fwrite(wire, 1, link_encode(LINK_CMD_TRACE, seq++, payload, n + 3, wire), stdout);
+    }
+    payload[0] = LINK_TRACE_PLAY;
+    fwrite(wire, 1, link_encode(LINK_CMD_TRACE, seq, payload, 1, wire), stdout);
+    return 0;
+}
+
+static int encode(int argc, char **argv) {
+    uint8_t payload[4];
+    uint32_t len = 0;
+    uint8_t type;
+    const char *cmd = argv[0];
+    long a = argc > 1 ? strtol(argv[1], NULL, 0) : 0;
+    long b = argc > 2 ? strtol(argv[2], NULL, 0) : 0;
+    if (strcmp(cmd, "rate") == 0 && argc == 2) {
+        type = LINK_CMD_RATE;
+        link_put16(payload, (uint16_t) a);
+        len = 2;
+    } else if (strcmp(cmd, "stat") == 0 && argc == 3) {
+        type = LINK_CMD_SET_STAT;
+        payload[0] = (uint8_t) a;
+        payload[1] = (uint8_t) b;
+        len = 2;
+    } else if (strcmp(cmd, "input") == 0 && argc == 2) {
+        type = LINK_CMD_INPUT;
+        payload[0] = (uint8_t) a;
+        len = 1;
+    } else if (strcmp(cmd, "action") == 0 && argc == 3) {
+        type = LINK_CMD_ACTION;
+        payload[0] = (uint8_t) a;
+        payload[1] = (uint8_t) b;
+        len = 2;
+    } else if (strcmp(cmd, "profile") == 0 && argc <= 2) {
+        type = LINK_CMD_PROFILE;
+        payload[0] = argc == 2 && strcmp(argv[1], "reset") == 0;
+        len = 1;
+    } else if (strcmp(cmd, "trace") == 0 && argc == 2) {
+        static const char *ops[] = {"record", "stop", NULL, "play"};
+        type = LINK_CMD_TRACE;
+        payload[0] = 0xFF;
+        for (uint8_t op = 0; op < 4; op++)
+            if (ops[op] != NULL && strcmp(argv[1], ops[op]) == 0)
+                payload[0] = op;
+        if (payload[0] == 0xFF) {
+            fprintf(stderr, "operacao desconhecida: %s\n", argv[1]);
+            return 2;
+        }
+        len = 1;
+    } else if (strcmp(cmd, "replay") == 0 && argc == 2) {
+        return encode_replay(argv[1]);
+    } else if (strcmp(cmd, "history") == 0 && argc == 1) {
+        type = LINK_CMD_HISTORY;
+    } else {
+        fprintf(stderr, "comando desconhecido: %s\n", cmd);
+        return 2;
+    }
+    uint8_t wire[LINK_WIRE_MAX];
+    fwrite(wire, 1, link_encode(type, 0, payload, len, wire), stdout);
+    return 0;
+}
+
+static bool load_profile(const char *path, profile_t *profile) {
+    FILE *in = fopen(path, "rb");
+    if (in == NULL) {
+        perror(path);
+        return false;
+    }
+    last_profile.count = 0;
+    decode(in, NULL, NULL);
+    fclose(in);
+    *profile = last_profile;
+    for (int i = 0; i < profile->count; i++)
+        profile->sections[i].name = profile->names[i];
+    if (profile->count == 0)
+        fprintf(stderr, "%s: nenhum perfil no fluxo\n", path);
+    return profile->count > 0;
+}
+
+/**
+ * Compara a média e o máximo de cada trecho entre dois fluxos, por exemplo
+ * de duas versões do firmware reproduzindo o mesmo traço. Retorna 1 se
+ * alguma média piorou mais que REGRESSION_PCT.
+ */
+static int compare(const char *base_path, const char *new_path) {
+    static profile_t base, next;
+    quiet = true;
+    if (!load_profile(base_path, &base) || !load_profile(new_path, &next))
+        return 2;
+    int regressions = 0;
+    printf("trecho       n base/novo     media base/novo (us)   max base/novo (us)\n");
+    for (int i = 0; i < next.count; i++) {
+        const prof_section_t *n = &next.sections[i], *b = NULL;
+        for (int j = 0; j < base.count; j++)
+            if (strcmp(base.sections[j].name, n->name) == 0)
+                b = &base.sections[j];
+        if (b == NULL || b->count == 0 || n->count == 0) {
+            printf("  %-10s sem base\n", n->name);
+            continue;
+        }
+        double mean_b = (double) b->total_us / b->count, mean_n = (double) n->total_us / n->count;
+        bool worse = mean_n > mean_b * (100 + REGRESSION_PCT) / 100 && mean_n - mean_b >= 1;
+        regressions += worse;
+        printf("  %-10s %6lu/%-6lu %9.1f/%-9.1f %8lu/%-8lu%s\n", n->name, (unsigned long) b->count,
+               (unsigned long) n->count, mean_b, mean_n, (unsigned long) b->max_us,
+               (unsigned long) n->max_us, worse ? "  REGRESSAO" : "");
+    }
+    printf("%d regressoes\n", regressions);
+    return regressions > 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 3 && strcmp(argv[1], "-e") == 0)
+        return encode(argc - 2, argv + 2);
+    if (argc == 4 && strcmp(argv[1], "-c") == 0)
+        return compare(argv[2], argv[3]);
+    const char *trace_path = NULL, *history_path = NULL;
+    int arg = 1;
+    for (; arg + 1 < argc; arg += 2) {
+        if (strcmp(argv[arg], "-x") == 0)
+            trace_path = argv[arg + 1];
+        else if (strcmp(argv[arg], "-H") == 0)
+            history_path = argv[arg + 1];
+        else
+            break;
+    }
+    if (argc > arg + 1 || (argc == arg + 1 && argv[arg][0] == '-')) {
+        fprintf(stderr, "uso: %s [-x traco.bin] [-H hist.csv] [fluxo.bin] | "
+                "-e <comando> [args] | -c base.bin novo.bin\n", argv[0]);
+        return 2;
+    }
+    FILE *in = argc == arg + 1 ? fopen(argv[arg], "rb") : stdin;
+    if (in == NULL) {
+        perror(argv[arg]);
+        return 1;
+    }
+    return decode(in, trace_path, history_path);
+}
@@ -0,0 +1,179 @@
+// Mede o oponente de mnk.h: para cada tabuleiro e prazo por jogada, a
+// profundidade alcançada e os nós por segundo, e o que cada nível de força
+// gasta. Antes, confere que o nível difícil joga perfeito no 3x3: em toda
+// posição alcançável com o Bob na vez, o lance escolhido tem o mesmo valor
+// que o melhor lance de uma busca exaustiva.
+//
+//   gcc -O2 -Iinc host/tools/mnkbench.c inc/mnk.c -o mnkbench
+//   mnkbench [prazo_ms ...]      (padrão: 1 5 20 100)
+//
+// Sai com 1 se o 3x3 não for perfeito.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mnk.h"
+
+static mnk_engine_t engine;
+
+static uint32_t clock_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000ull + ts.tv_nsec / 1000);
+}
+
+// ---------------------- Conferência no 3x3 ----------------------
+// Valor de cada posição para quem joga (1 vence, 0 empata, -1 perde),
+// guardado pelo índice em base 3.
+
+static mnk_rules_t ttt;
+static int8_t solved[19683];
+static bool known[19683];
+
+static int position_index(const mnk_board_t *board) {
+    int index = 0;
+    for (int cell = ttt.cells - 1; cell >= 0; cell--)
+        index = index * 3 + mnk_owner(board, cell);
+    return index;
+}
+
+static int solve(const mnk_board_t *board, int player) {
+    int index = position_index(board);
+    if (known[index])
+        return solved[index];
+    int best = -2;
+    uint32_t free_cells = mnk_free_mask(&ttt, board);
+    for (int cell = 0; cell < ttt.cells; cell++) {
+        if (!((free_cells >> cell) & 1))
+            continue;
+        mnk_board_t next = *board;
+        mnk_play(&next, player, cell);
+        int winner = mnk_winner(&ttt, &next);
+        int value = winner == player ? 1 : winner == -1 ? 0 : -solve(&next, 3 - player);
+        if (value > best)
+            best = value;
+    }
+    known[index] = true;
+    solved[index] = (int8_t) best;
+    return best;
+}
+
+static int positions, mistakes;
+
+/**
+ * Percorre todas as partidas em que o Bob (jogador bob) responde com o nível
+ * difícil e o outro jogador tenta todos os lances.
+ */
+static void walk(mnk_board_t *board, int player, int bob) {
+    if (mnk_winner(&ttt, board) != 0)
+        return;
+    if (player == bob) {
+        mnk_result_t result;
+        int cell = mnk_search(&engine, &ttt, board, bob, &mnk_levels[MNK_HARD], 0, NULL, &result);
+        mnk_board_t next = *board;
+        mnk_play(&next, bob, cell);
+        int winner = mnk_winner(&ttt, &next);
+        int value = winner == bob ? 1 : winner == -1 ? 0 : -solve(&next, 3 - bob);
+        positions++;
+        mistakes += value != solve(board, bob);
+        walk(&next, 3 - bob, bob);
+        return;
+    }
+    uint32_t free_cells = mnk_free_mask(&ttt, board);
+    for (int cell = 0; cell < ttt.cells; cell++) {
+        if (!((free_cells >> cell) & 1))
+            continue;
+        mnk_board_t next = *board;
+        mnk_play(&next, player, cell);
+        walk(&next, 3 - player, bob);
+    }
+}
+
+static bool check_perfect(void) {
+    mnk_rules_init(&ttt, 3, 3, 3);
+    mnk_engine_clear(&engine);
+    for (int bob = 1; bob <= 2; bob++) {
+        mnk_board_t board;
+        mnk_reset(&board);
+        walk(&board, 1, bob);
+    }
+    printf("3x3 difícil: %d posições, %d lances abaixo do ótimo\n", positions, mistakes);
+    return mistakes == 0;
+}
+
+// ---------------------- Medição ----------------------
+
+typedef struct {
+    int width, height, k;
+} variant_t;
+
+static const variant_t variants[] = {{3, 3, 3}, {4, 4, 3}, {5, 5, 4}, {7, 4, 4}};
+
+static void bench_budget(const mnk_rules_t *rules, uint32_t budget_us) {
+    mnk_level_t level = {.max_depth = MNK_MAX_CELLS, .max_work = UINT32_MAX,
+                         .budget_us = budget_us};
+    mnk_board_t board;
+    mnk_reset(&board);
+    mnk_engine_clear(&engine);
+    mnk_result_t result;
+    uint32_t start = clock_us();
+    mnk_search(&engine, rules, &board, 1, &level, 0, clock_us, &result);
+    uint32_t elapsed = clock_us() - start;
+    printf("  prazo %6.1f ms: profundidade %2u, %8lu nós em %7.2f ms, %6.2f M nós/s, casa %d%s\n",
+           budget_us / 1000.0, result.depth, (unsigned long) result.nodes, elapsed / 1000.0,
+           elapsed ? result.nodes / (double) elapsed : 0.0, result.move,
+           result.score >= MNK_WIN - MNK_MAX_CELLS ? " (vence)" :
+           result.score <= -(MNK_WIN - MNK_MAX_CELLS) ? " (perde)" : "");
+}
+
+static void bench_levels(const mnk_rules_t *rules) {
+    static const char *names[MNK_LEVELS] = {"fácil", "normal", "difícil"};
+    for (int l = 0; l < MNK_LEVELS; l++) {
+        // Sem o lance ao acaso, para medir a busca.
+        mnk_level_t level = mnk_levels[l];
+        level.random_pct = 0;
+        mnk_board_t board;
+        mnk_reset(&board);
+        mnk_engine_clear(&engine);
+        mnk_result_t result;
+        uint32_t start = clock_us();
+        mnk_search(&engine, rules, &board, 1, &level, 0, clock_us, &result);
+        uint32_t elapsed = clock_us() - start;
+        printf("  nível %-8s profundidade %2u, %6lu nós em %6.2f ms%s\n", names[l],
+               result.depth, (unsigned long) result.nodes, elapsed / 1000.0,
+               result.timeout ? " (prazo)" : "");
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t budgets[16];
+    int n = 0;
+    for (int i = 1; i < argc; i++) {
+        if (n == 16 || atof(argv[i]) <= 0) {
+            fprintf(stderr, "uso: %s [prazo_ms ...]\n", argv[0]);
+            return 2;
+        }
+        budgets[n++] = (uint32_t)(atof(argv[i]) * 1000);
+    }
+    if (n == 0) {
+        budgets[n++] = 1000;
+        budgets[n++] = 5000;
+        budgets[n++] = 20000;
+        budgets[n++] = 100000;
+    }
+    mnk_engine_init(&engine);
+    bool ok = check_perfect();
+
+    for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++) {
+        mnk_rules_t rules;
+        mnk_rules_init(&rules, variants[v].width, variants[v].height, variants[v].k);
+        printf("%dx%d, %d em linha (%d linhas), tabuleiro vazio:\n", variants[v].width,
+               variants[v].height, variants[v].k, rules.line_count);
+        for (int i = 0; i < n; i++)
+            bench_budget(&rules, budgets[i]);
+        bench_levels(&rules);
+    }
+    return ok ? 0 : 1;
+}
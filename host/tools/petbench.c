@@ -0,0 +1,172 @@
+// Mede o núcleo de pet_store.h em populações grandes: cada rodada aplica um
+// passo de decaimento e recalcula o humor de todos os pets, com a população
+// dividida em faixas entre as threads de um pool fixo.
+//
+//   gcc -O3 -march=native -Iinc host/tools/petbench.c inc/pet.c inc/pet_store.c -lpthread -o petbench
+//   petbench [-t threads] [pets ...]      (padrão: 1000 1000000 10000000)
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pet.h"
+#include "pet_store.h"
+
+#define INTERVAL_MS     60000
+#define MIN_SECONDS     0.5         // Cada tamanho roda ao menos este tempo
+#define MIN_ROUNDS      3
+#define CHECKS          1000        // Pets conferidos contra o pet_t
+
+// Mesmas quedas por passo das dificuldades do firmware.
+static const uint16_t rates_q8[3] = {4 * PET_ONE, 5 * PET_ONE, 15 * PET_ONE / 2};
+
+// ---------------------- Pool de Threads ----------------------
+// As threads vivem durante todo o teste e se encontram em duas barreiras por
+// rodada: uma para começar, com os passos já calculados, e outra ao fim.
+
+typedef struct {
+    pthread_t thread;
+    uint32_t first, count;          // Faixa da população
+} worker_t;
+
+static pet_store_t store;
+static uint32_t round_steps;
+static volatile int stop;
+static pthread_barrier_t start_barrier, done_barrier;
+
+static void *worker_main(void *arg) {
+    worker_t *w = arg;
+    while (true) {
+        pthread_barrier_wait(&start_barrier);
+        if (stop)
+            return NULL;
+        pet_store_decay(&store, w->first, w->count, round_steps);
+        pet_store_classify(&store, w->first, w->count);
+        pthread_barrier_wait(&done_barrier);
+    }
+}
+
+static double seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *alloc(size_t size) {
+    // Alinhado à linha de cache, para as faixas não dividirem linhas à toa.
+    void *p = aligned_alloc(64, (size + 63) & ~(size_t) 63);
+    if (p == NULL) {
+        fprintf(stderr, "sem memória para %zu bytes\n", size);
+        exit(1);
+    }
+    return p;
+}
+
+static uint16_t initial_q8(uint32_t index, int stat) {
+    return (uint16_t)((index * 2654435761u >> (8 + 4 * stat)) % (PET_MAX_Q8 + 1));
+}
+
+/**
+ * Confere pets espalhados pela população com o pet_t do firmware.
+ */
+static int check(uint32_t count, uint64_t now_ms) {
+    int bad = 0;
+    for (uint32_t k = 0; k < CHECKS && k < count; k++) {
+        uint32_t index = (uint32_t)((uint64_t) k * count / (CHECKS < count ? CHECKS : count));
+        uint16_t values[PET_STATS];
+        for (int s = 0; s < PET_STATS; s++)
+            values[s] = initial_q8(index, s);
+        pet_t pet;
+        pet_init(&pet, values, INTERVAL_MS);
+        pet_start(&pet, store.rate_q8[index], 0);
+        for (int s = 0; s < PET_STATS; s++)
+            bad += pet_get_q8(&pet, (pet_stat_t) s, now_ms) != store.stat_q8[s][index];
+        bad += pet_mood(&pet, now_ms) != store.mood[index];
+    }
+    return bad;
+}
+
+static void run(uint32_t count, int threads) {
+    uint16_t *stats[PET_STATS];
+    for (int s = 0; s < PET_STATS; s++)
+        stats[s] = alloc(count * sizeof(uint16_t));
+    uint16_t *rate = alloc(count * sizeof(uint16_t));
+    uint8_t *mood = alloc(count);
+    for (uint32_t i = 0; i < count; i++) {
+        for (int s = 0; s < PET_STATS; s++)
+            stats[s][i] = initial_q8(i, s);
+        rate[i] = rates_q8[i % 3];
+    }
+    pet_store_init(&store, count, stats, rate, mood, INTERVAL_MS);
+
+    worker_t workers[threads];
+    stop = 0;
+    pthread_barrier_init(&start_barrier, NULL, (unsigned) threads + 1);
+    pthread_barrier_init(&done_barrier, NULL, (unsigned) threads + 1);
+    for (int t = 0; t < threads; t++) {
+        workers[t].first = (uint32_t)((uint64_t) count * t / threads);
+        workers[t].count = (uint32_t)((uint64_t) count * (t + 1) / threads) - workers[t].first;
+        pthread_create(&workers[t].thread, NULL, worker_main, &workers[t]);
+    }
+
+    // Cada rodada avança o relógio um passo.
+    uint64_t now_ms = 0;
+    uint32_t rounds = 0;
+    double start = seconds(), elapsed;
+    do {
+        now_ms += INTERVAL_MS;
+        round_steps = pet_store_steps(&store, now_ms);
+        pthread_barrier_wait(&start_barrier);
+        pthread_barrier_wait(&done_barrier);
+        pet_store_commit(&store, round_steps, now_ms);
+        rounds++;
+        elapsed = seconds() - start;
+    } while (elapsed < MIN_SECONDS || rounds < MIN_ROUNDS);
+
+    stop = 1;
+    pthread_barrier_wait(&start_barrier);
+    for (int t = 0; t < threads; t++)
+        pthread_join(workers[t].thread, NULL);
+    pthread_barrier_destroy(&start_barrier);
+    pthread_barrier_destroy(&done_barrier);
+
+    int bad = check(count, now_ms);
+    printf("%10lu pets: %6lu rodadas, %8.2f M pets/s, %6.2f ns/pet%s\n",
+           (unsigned long) count, (unsigned long) rounds, count * (double) rounds / elapsed / 1e6,
+           elapsed * 1e9 / ((double) count * rounds), bad ? " (DIVERGE do pet_t)" : "");
+
+    for (int s = 0; s < PET_STATS; s++)
+        free(stats[s]);
+    free(rate);
+    free(mood);
+}
+
+int main(int argc, char **argv) {
+    int threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t sizes[16];
+    int n = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else if (n < 16 && atol(argv[i]) > 0)
+            sizes[n++] = (uint32_t) atol(argv[i]);
+        else {
+            fprintf(stderr, "uso: %s [-t threads] [pets ...]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (n == 0) {
+        sizes[n++] = 1000;
+        sizes[n++] = 1000000;
+        sizes[n++] = 10000000;
+    }
+    if (threads < 1)
+        threads = 1;
+    printf("%d threads\n", threads);
+    for (int i = 0; i < n; i++)
+        run(sizes[i], threads);
+    return 0;
+}
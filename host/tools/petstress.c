@@ -0,0 +1,216 @@
+// Teste de carga de pet_shared.h com threads concorrentes.
+//
+//   gcc -O2 -Iinc host/tools/petstress.c inc/pet.c inc/pet_store.c inc/pet_shared.c -lpthread -o petstress
+//   petstress [segundos] [leitores] [mutadores]      (padrão: 2 4 4)
+//
+// Leitura: o dono alterna o pet entre dois estados, A e B, que diferem em
+// todos os campos; qualquer retrato que não seja A nem B é uma leitura
+// rasgada. Escrita: os mutadores não tocam no pet; postam pares +1 e -1 no
+// mesmo atributo em acumuladores atômicos saturados, o dono retira os
+// acumulados a cada volta e, no fim, o total retirado tem de bater com o
+// postado. Os acumuladores ficam só aqui: o firmware tem um único escritor
+// e não precisa deles, e no M0+ cada operação atômica de leitura e escrita
+// vira chamada de biblioteca. Sai com 1 se algo divergir.
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pet.h"
+#include "pet_shared.h"
+
+#define INTERVAL_MS     60000
+
+static const uint16_t state_a[PET_STATS] = {10 * PET_ONE, 20 * PET_ONE, 30 * PET_ONE, 40 * PET_ONE};
+
+// Os dois estados da fase de leitura; a âncora é par em A e ímpar em B.
+static const pet_t pet_a = {
+    .base_q8 = {10 * PET_ONE, 20 * PET_ONE, 30 * PET_ONE, 40 * PET_ONE},
+    .interval_ms = INTERVAL_MS, .rate_q8 = 4 * PET_ONE,
+};
+static const pet_t pet_b = {
+    .base_q8 = {90 * PET_ONE, 80 * PET_ONE, 70 * PET_ONE, 60 * PET_ONE},
+    .interval_ms = 2 * INTERVAL_MS, .rate_q8 = 6 * PET_ONE,
+};
+
+static pet_shared_t shared;
+static int32_t pending[PET_STATS];  // Pontos postados, em [-PET_MAX, PET_MAX]
+static volatile int running;
+
+typedef struct {
+    pthread_t thread;
+    unsigned seed;
+    unsigned long reads, torn, posts;
+    long posted[PET_STATS];
+} worker_t;
+
+static double seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Posta delta pontos para o dono aplicar, sem trava. O acumulado satura em
+ * ±PET_MAX: aplicado de uma vez, qualquer valor além disso já leva o
+ * atributo ao limite.
+ */
+static void post(pet_stat_t stat, int delta) {
+    int32_t old = __atomic_load_n(&pending[stat], __ATOMIC_RELAXED), sum;
+    do {
+        sum = old + delta;
+        sum = sum > PET_MAX ? PET_MAX : sum < -PET_MAX ? -PET_MAX : sum;
+    } while (!__atomic_compare_exchange_n(&pending[stat], &old, sum, true, __ATOMIC_RELEASE,
+                                          __ATOMIC_RELAXED));
+}
+
+/** Retira os pontos postados de um atributo. */
+static int32_t take(pet_stat_t stat) {
+    return __atomic_exchange_n(&pending[stat], 0, __ATOMIC_ACQUIRE);
+}
+
+/** O dono aplica os pontos postados numa única escrita. */
+static void drain(uint64_t now_ms) {
+    int8_t delta[PET_STATS];
+    for (int i = 0; i < PET_STATS; i++)
+        delta[i] = (int8_t) take((pet_stat_t) i);
+    pet_shared_apply(&shared, delta, now_ms);
+}
+
+static void *reader_main(void *arg) {
+    worker_t *w = arg;
+    while (running) {
+        pet_t pet;
+        pet_shared_read(&shared, &pet);
+        bool is_a = memcmp(pet.base_q8, pet_a.base_q8, sizeof(pet.base_q8)) == 0 &&
+                    pet.interval_ms == pet_a.interval_ms && pet.rate_q8 == pet_a.rate_q8 &&
+                    (pet.anchor_ms & 1) == 0;
+        bool is_b = memcmp(pet.base_q8, pet_b.base_q8, sizeof(pet.base_q8)) == 0 &&
+                    pet.interval_ms == pet_b.interval_ms && pet.rate_q8 == pet_b.rate_q8 &&
+                    (pet.anchor_ms & 1) == 1;
+        w->torn += !(is_a || is_b);
+        w->reads++;
+    }
+    return NULL;
+}
+
+static void *mutator_main(void *arg) {
+    worker_t *w = arg;
+    // Em pares, o acumulado de cada atributo não passa do número de
+    // mutadores e nunca satura.
+    while (running) {
+        pet_stat_t stat = (pet_stat_t)(rand_r(&w->seed) % PET_STATS);
+        post(stat, 1);
+        w->posted[stat]++;
+        post(stat, -1);
+        w->posted[stat]--;
+        w->posts += 2;
+    }
+    return NULL;
+}
+
+/**
+ * Saturação dos acumulados, numa thread só.
+ */
+static bool check_saturation(void) {
+    pet_shared_init(&shared, state_a, INTERVAL_MS);
+    post(PET_FOME, 70);
+    post(PET_FOME, 70);                 // Acumulado satura em 100
+    post(PET_HIGIENE, -70);
+    post(PET_HIGIENE, -70);             // -100
+    post(PET_HIGIENE, 5);               // -95: 20 pontos -> 0
+    drain(0);
+    pet_view_t view;
+    pet_shared_view(&shared, 0, &view);
+    return pending[PET_FOME] == 0 && pet_view_get(&view, PET_FOME) == PET_MAX &&
+           pet_view_get(&view, PET_HIGIENE) == 0 && pet_view_get(&view, PET_ENERGIA) == 30;
+}
+
+static bool read_phase(double duration, int readers) {
+    pet_shared_init(&shared, pet_a.base_q8, INTERVAL_MS);
+    shared.pet = pet_a;
+    worker_t workers[readers];
+    memset(workers, 0, sizeof(workers));
+    running = 1;
+    for (int i = 0; i < readers; i++)
+        pthread_create(&workers[i].thread, NULL, reader_main, &workers[i]);
+
+    unsigned long writes = 0;
+    double end = seconds() + duration;
+    while (seconds() < end) {
+        pet_shared_write_begin(&shared);
+        shared.pet = writes % 2 ? pet_a : pet_b;
+        shared.pet.anchor_ms = writes + 1;
+        pet_shared_write_end(&shared);
+        writes++;
+    }
+    running = 0;
+    unsigned long reads = 0, torn = 0;
+    for (int i = 0; i < readers; i++) {
+        pthread_join(workers[i].thread, NULL);
+        reads += workers[i].reads;
+        torn += workers[i].torn;
+    }
+    printf("leitura: %lu escritas, %lu retratos, %lu rasgados\n", writes, reads, torn);
+    return torn == 0 && reads > 0;
+}
+
+static bool write_phase(double duration, int mutators) {
+    pet_shared_init(&shared, state_a, INTERVAL_MS);
+    worker_t workers[mutators];
+    memset(workers, 0, sizeof(workers));
+    running = 1;
+    for (int i = 0; i < mutators; i++) {
+        workers[i].seed = (unsigned) i + 1;
+        pthread_create(&workers[i].thread, NULL, mutator_main, &workers[i]);
+    }
+
+    // O dono soma o que retirou, em vez de deixar o pet saturar.
+    long applied[PET_STATS] = {0};
+    unsigned long drains = 0;
+    double end = seconds() + duration;
+    bool stopped = false;
+    while (true) {
+        if (!stopped && seconds() >= end) {
+            running = 0;
+            for (int i = 0; i < mutators; i++)
+                pthread_join(workers[i].thread, NULL);
+            stopped = true;
+        }
+        for (int i = 0; i < PET_STATS; i++)
+            applied[i] += take((pet_stat_t) i);
+        drains++;
+        if (stopped)
+            break;
+    }
+    bool ok = true;
+    unsigned long posts = 0;
+    for (int m = 0; m < mutators; m++)
+        posts += workers[m].posts;
+    for (int i = 0; i < PET_STATS; i++) {
+        long posted = 0;
+        for (int m = 0; m < mutators; m++)
+            posted += workers[m].posted[i];
+        ok &= posted == applied[i];
+    }
+    printf("escrita: %lu drenagens, %lu postagens, %s\n", drains, posts,
+           ok ? "igual à retirada" : "DIVERGE da retirada");
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    double duration = argc > 1 ? atof(argv[1]) : 2;
+    int readers = argc > 2 ? atoi(argv[2]) : 4;
+    int mutators = argc > 3 ? atoi(argv[3]) : 4;
+    if (duration <= 0 || readers < 1 || mutators < 1) {
+        fprintf(stderr, "uso: %s [segundos] [leitores] [mutadores]\n", argv[0]);
+        return 2;
+    }
+    bool ok = check_saturation();
+    printf("saturação: %s\n", ok ? "ok" : "FALHOU");
+    ok &= read_phase(duration, readers);
+    ok &= write_phase(duration, mutators);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,16 @@
+#ifndef HOST_TUSB_H
+#define HOST_TUSB_H
+
+#include "pico/stdlib.h"
+
+// Stand-in do subconjunto do TinyUSB usado pelo firmware.
+bool tusb_init(void);
+void tud_task(void);
+bool tud_cdc_connected(void);
+uint32_t tud_cdc_available(void);
+uint32_t tud_cdc_read(void *buffer, uint32_t bufsize);
+uint32_t tud_cdc_write_available(void);
+uint32_t tud_cdc_write(const void *buffer, uint32_t bufsize);
+uint32_t tud_cdc_write_flush(void);
+
+#endif
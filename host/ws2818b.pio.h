@@ -0,0 +1,23 @@
+#ifndef HOST_WS2818B_PIO_H
+#define HOST_WS2818B_PIO_H
+
+#include "hardware/pio.h"
+
+// Stand-in do programa PIO gerado por pioasm: o simulador só precisa saber
+// quantos bits cada palavra do FIFO carrega (autopull de 8 bits, MSB primeiro).
+static const uint16_t ws2818b_program_instructions[4] = {0};
+static const pio_program_t ws2818b_program = {
+    .instructions = ws2818b_program_instructions,
+    .length = 4,
+    .origin = -1,
+};
+
+static inline void ws2818b_program_init(PIO pio, uint sm, uint offset, uint pin, float freq) {
+    (void) offset;
+    (void) pin;
+    (void) freq;
+    hw_write_masked(&pio->sm[sm].shiftctrl, 8u << PIO_SM0_SHIFTCTRL_PULL_THRESH_LSB,
+                    PIO_SM0_SHIFTCTRL_PULL_THRESH_BITS);
+}
+
+#endif
@@ -0,0 +1,106 @@
+#include <string.h>
+
+#include "anim.h"
+
+const panel_layout_t anim_panel = {
+    .width = ANIM_SIDE, .height = ANIM_SIDE, .order = PANEL_ROW_MAJOR,
+    .rotation = PANEL_ROT_0, .bottom_first = true, .strips = 1,
+};
+
+static void sprite_render(const anim_sprite_t *sprite, anim_rgb_t *out) {
+    memset(out, 0, sizeof(anim_rgb_t) * ANIM_PIXELS);
+    for (int l = 0; l < ANIM_LAYERS; l++) {
+        const anim_layer_t *layer = &sprite->layers[l];
+        for (int i = 0; i < ANIM_PIXELS; i++)
+            if ((layer->mask >> i) & 1)
+                out[i] = layer->color;
+    }
+}
+
+static uint8_t mix(uint8_t a, uint8_t b, uint32_t t, uint32_t total) {
+    return (uint8_t)((int32_t) a + ((int32_t) b - (int32_t) a) * (int32_t) t / (int32_t) total);
+}
+
+void anim_play(anim_player_t *player, const anim_clip_t *clip, anim_done_fn done,
+               uint32_t now_ms) {
+    player->clip = clip;
+    player->key = 0;
+    player->pass = 0;
+    player->done = done;
+    player->playing = clip->count > 0;
+    player->key_start_ms = now_ms;
+    memcpy(player->from, player->frame, sizeof(player->from));
+}
+
+void anim_show(anim_player_t *player, const anim_sprite_t *sprite, uint16_t fade_ms,
+               uint32_t now_ms) {
+    if (player->clip == &player->single_clip && player->single.sprite == sprite)
+        return;
+    player->single.sprite = sprite;
+    player->single.fade_ms = fade_ms;
+    player->single.hold_ms = 0;
+    player->single_clip.keys = &player->single;
+    player->single_clip.count = 1;
+    player->single_clip.repeat = 1;
+    anim_play(player, &player->single_clip, NULL, now_ms);
+}
+
+anim_rgb_t *anim_canvas(anim_player_t *player) {
+    player->clip = NULL;
+    player->playing = false;
+    return player->frame;
+}
+
+bool anim_update(anim_player_t *player, uint32_t now_ms) {
+    if (!player->playing)
+        return false;
+    const anim_clip_t *clip = player->clip;
+    anim_rgb_t next[ANIM_PIXELS];
+    bool finished = false;
+
+    while (true) {
+        const anim_key_t *key = &clip->keys[player->key];
+        uint32_t elapsed = now_ms - player->key_start_ms;
+        uint32_t length = (uint32_t) key->fade_ms + key->hold_ms;
+        sprite_render(key->sprite, next);
+        if (elapsed < length) {
+            if (elapsed < key->fade_ms)
+                for (int i = 0; i < ANIM_PIXELS; i++) {
+                    next[i].r = mix(player->from[i].r, next[i].r, elapsed, key->fade_ms);
+                    next[i].g = mix(player->from[i].g, next[i].g, elapsed, key->fade_ms);
+                    next[i].b = mix(player->from[i].b, next[i].b, elapsed, key->fade_ms);
+                }
+            break;
+        }
+
+        // Chave concluída: a próxima transição parte do sprite dela.
+        memcpy(player->from, next, sizeof(next));
+        player->key_start_ms += length;
+        if (++player->key == clip->count) {
+            player->key = 0;
+            if (clip->repeat != 0 && ++player->pass == clip->repeat) {
+                player->key = clip->count - 1;
+                player->playing = false;
+                finished = true;
+                break;
+            }
+        }
+    }
+
+    bool changed = memcmp(next, player->frame, sizeof(next)) != 0;
+    memcpy(player->frame, next, sizeof(next));
+    if (finished && player->done != NULL)
+        player->done();
+    return changed;
+}
+
+uint32_t anim_next_ms(const anim_player_t *player, uint32_t now_ms) {
+    if (!player->playing)
+        return ANIM_IDLE;
+    const anim_key_t *key = &player->clip->keys[player->key];
+    uint32_t elapsed = now_ms - player->key_start_ms;
+    if (elapsed < key->fade_ms)
+        return ANIM_FRAME_MS;
+    uint32_t length = (uint32_t) key->fade_ms + key->hold_ms;
+    return elapsed < length ? length - elapsed : 1;
+}
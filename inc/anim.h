@@ -0,0 +1,106 @@
+#ifndef ANIM_H
+#define ANIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "panel.h"
+
+// ---------------------- Animação da Matriz de LEDs ----------------------
+// Sprites e linhas do tempo são constantes (ficam na flash). Um clipe é uma
+// sequência de quadros-chave, cada um com o tempo de transição a partir do
+// quadro anterior (crossfade) e o tempo parado. O player avança por
+// anim_update(), chamada por uma tarefa agendada, e só indica mudança
+// quando o quadro resultante muda. Não depende do pico-sdk.
+
+#define ANIM_SIDE       5           // Quadro de ANIM_SIDE x ANIM_SIDE pixels
+#define ANIM_PIXELS     (ANIM_SIDE * ANIM_SIDE)
+#define ANIM_LAYERS     2
+#define ANIM_FRAME_MS   20          // Período de atualização durante transições
+#define ANIM_IDLE       UINT32_MAX  // Nada a atualizar
+
+// Máscara de 25 bits a partir de cinco linhas de 5 bits, de cima para baixo,
+// com a coluna 0 no bit mais alto (o literal binário se lê como o desenho).
+// O bit i corresponde ao LED i da fita, que começa pela linha de baixo.
+#define ANIM_REV5(v)    ((((v) & 1) << 4) | (((v) & 2) << 2) | ((v) & 4) | \
+                         (((v) & 8) >> 2) | (((v) & 16) >> 4))
+#define ANIM_ROWS(r0, r1, r2, r3, r4) \
+    ((uint32_t) ANIM_REV5(r0) << 20 | (uint32_t) ANIM_REV5(r1) << 15 | \
+     (uint32_t) ANIM_REV5(r2) << 10 | (uint32_t) ANIM_REV5(r3) << 5 | (uint32_t) ANIM_REV5(r4))
+
+typedef struct {
+    uint8_t r, g, b;
+} anim_rgb_t;
+
+/** Ordem dos pixels no quadro: a de ANIM_ROWS, linhas a partir da de baixo. */
+extern const panel_layout_t anim_panel;
+
+typedef struct {
+    uint32_t mask;                  // LEDs acesos pela camada
+    anim_rgb_t color;
+} anim_layer_t;
+
+/** Camadas desenhadas em ordem; LEDs fora de todas ficam apagados. */
+typedef struct {
+    anim_layer_t layers[ANIM_LAYERS];
+} anim_sprite_t;
+
+typedef struct {
+    const anim_sprite_t *sprite;
+    uint16_t fade_ms;               // Transição a partir do quadro anterior
+    uint16_t hold_ms;               // Tempo parado depois da transição
+} anim_key_t;
+
+typedef struct {
+    const anim_key_t *keys;
+    uint8_t count;
+    uint8_t repeat;                 // Vezes que a sequência toca (0 = sem fim)
+} anim_clip_t;
+
+typedef void (*anim_done_fn)(void);
+
+typedef struct {
+    anim_rgb_t frame[ANIM_PIXELS];  // Último quadro calculado (ordem da fita)
+    anim_rgb_t from[ANIM_PIXELS];   // Início da transição atual
+    const anim_clip_t *clip;        // NULL = parado
+    anim_key_t single;              // Chave de anim_show()
+    anim_clip_t single_clip;
+    uint8_t key;
+    uint8_t pass;
+    bool playing;
+    uint32_t key_start_ms;
+    anim_done_fn done;
+} anim_player_t;
+
+/**
+ * Toca um clipe a partir do quadro atual; done é chamada ao fim (clipes
+ * sem fim nunca terminam).
+ */
+void anim_play(anim_player_t *player, const anim_clip_t *clip, anim_done_fn done,
+               uint32_t now_ms);
+
+/**
+ * Transição do quadro atual para um sprite, que fica na tela. Não faz nada
+ * se o sprite já for o destino.
+ */
+void anim_show(anim_player_t *player, const anim_sprite_t *sprite, uint16_t fade_ms,
+               uint32_t now_ms);
+
+/**
+ * Para o clipe e devolve o quadro para desenho direto (por exemplo, o
+ * tabuleiro do jogo). A próxima transição parte do que for desenhado.
+ */
+anim_rgb_t *anim_canvas(anim_player_t *player);
+
+/**
+ * Avança até now_ms. Retorna true se o quadro mudou.
+ */
+bool anim_update(anim_player_t *player, uint32_t now_ms);
+
+/**
+ * Tempo até a próxima chamada útil de anim_update (ANIM_IDLE se parado).
+ * Clipes sem fim precisam de chaves com duração.
+ */
+uint32_t anim_next_ms(const anim_player_t *player, uint32_t now_ms);
+
+#endif
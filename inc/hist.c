@@ -0,0 +1,227 @@
+#include <string.h>
+
+#include "hist.h"
+
+// Primeiro byte de um registro.
+#define HIST_CHANGED_MASK   0x0F        // Atributos alterados
+#define HIST_KIND_SHIFT     4           // Tipo nos bits 4-5
+#define HIST_SAME_DELTA     0x40        // Uma só variação para todos
+
+static uint8_t *hist_put32(uint8_t *p, uint32_t value) {
+    for (int i = 0; i < 4; i++)
+        *p++ = (uint8_t)(value >> (8 * i));
+    return p;
+}
+
+static uint32_t hist_get32(const uint8_t *p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+void hist_init(hist_t *hist, uint8_t *data, uint32_t capacity, uint32_t time_s,
+               const uint8_t values[PET_STATS]) {
+    hist->data = data;
+    hist->mask = capacity - 1;
+    hist->head = 0;
+    hist->tail = 0;
+    hist->first.time_s = time_s;
+    memcpy(hist->first.values, values, PET_STATS);
+    hist->last = hist->first;
+    hist->records = 0;
+    hist->dropped = 0;
+}
+
+/**
+ * Decodifica o registro em pos e o aplica a state. Retorna o tamanho, ou 0
+ * se o registro passar de head.
+ */
+static uint32_t hist_decode(const hist_t *hist, uint32_t pos, hist_state_t *state,
+                            hist_entry_t *entry) {
+    uint32_t start = pos, avail = hist->head - pos;
+    if (avail == 0)
+        return 0;
+    uint8_t packed = hist->data[pos++ & hist->mask];
+    uint32_t delta_s = 0;
+    for (int shift = 0;; shift += 7) {
+        if (pos - start >= avail || shift > 28)
+            return 0;
+        uint8_t byte = hist->data[pos++ & hist->mask];
+        delta_s |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            break;
+    }
+    uint8_t changed = packed & HIST_CHANGED_MASK;
+    int8_t delta = 0;
+    bool have_delta = false;
+    for (int i = 0; i < PET_STATS; i++) {
+        if (!((changed >> i) & 1))
+            continue;
+        if (!(packed & HIST_SAME_DELTA) || !have_delta) {
+            if (pos - start >= avail)
+                return 0;
+            delta = (int8_t) hist->data[pos++ & hist->mask];
+            have_delta = true;
+        }
+        state->values[i] = (uint8_t)(state->values[i] + delta);
+    }
+    state->time_s += delta_s;
+    if (entry != NULL) {
+        entry->kind = (packed >> HIST_KIND_SHIFT) & 3;
+        entry->changed = changed;
+        entry->state = *state;
+    }
+    return pos - start;
+}
+
+bool hist_append(hist_t *hist, uint8_t kind, uint32_t time_s, const uint8_t values[PET_STATS]) {
+    int8_t deltas[PET_STATS];
+    uint8_t changed = 0;
+    int count = 0;
+    bool same = true;
+    for (int i = 0; i < PET_STATS; i++) {
+        deltas[i] = (int8_t)(values[i] - hist->last.values[i]);
+        if (deltas[i] == 0)
+            continue;
+        same &= count == 0 || deltas[i] == deltas[__builtin_ctz(changed)];
+        changed |= 1u << i;
+        count++;
+    }
+    if (changed == 0)
+        return false;
+    if (time_s < hist->last.time_s)
+        time_s = hist->last.time_s;
+
+    uint8_t record[HIST_RECORD_MAX];
+    uint8_t *p = record;
+    same &= count > 1;
+    *p++ = (uint8_t)(changed | (kind & 3) << HIST_KIND_SHIFT | (same ? HIST_SAME_DELTA : 0));
+    // LEB128: 7 bits por byte, bit 7 indica continuação.
+    uint32_t delta_s = time_s - hist->last.time_s;
+    while (delta_s >= 0x80) {
+        *p++ = (uint8_t)(delta_s | 0x80);
+        delta_s >>= 7;
+    }
+    *p++ = (uint8_t) delta_s;
+    for (int i = 0; i < PET_STATS; i++) {
+        if (deltas[i] != 0) {
+            *p++ = (uint8_t) deltas[i];
+            if (same)
+                break;
+        }
+    }
+    uint32_t len = (uint32_t)(p - record);
+
+    // Os registros mais antigos passam para o estado inicial.
+    while (hist->head - hist->tail + len > hist->mask + 1) {
+        hist->tail += hist_decode(hist, hist->tail, &hist->first, NULL);
+        hist->dropped++;
+    }
+    for (uint32_t i = 0; i < len; i++)
+        hist->data[hist->head++ & hist->mask] = record[i];
+    hist->last.time_s = time_s;
+    memcpy(hist->last.values, values, PET_STATS);
+    hist->records++;
+    return true;
+}
+
+void hist_cursor_start(const hist_t *hist, hist_cursor_t *cursor) {
+    cursor->pos = hist->tail;
+    cursor->state = hist->first;
+}
+
+int hist_cursor_next(const hist_t *hist, hist_cursor_t *cursor, hist_entry_t *entry) {
+    if ((int32_t)(cursor->pos - hist->tail) < 0)
+        return -1;
+    uint32_t len = hist_decode(hist, cursor->pos, &cursor->state, entry);
+    cursor->pos += len;
+    return len != 0;
+}
+
+// ---------------------- Exportação ----------------------
+
+uint32_t hist_export_header(const hist_t *hist, uint32_t now_s, uint8_t *out) {
+    uint8_t *p = hist_put32(out, HIST_MAGIC);
+    *p++ = HIST_VERSION;
+    p = hist_put32(p, hist->first.time_s);
+    memcpy(p, hist->first.values, PET_STATS);
+    p = hist_put32(p + PET_STATS, now_s);
+    return (uint32_t)(p - out);
+}
+
+int hist_copy(const hist_t *hist, uint32_t pos, uint8_t *out, uint32_t len) {
+    if ((int32_t)(pos - hist->tail) < 0)
+        return -1;
+    if (len > hist->head - pos)
+        len = hist->head - pos;
+    for (uint32_t i = 0; i < len; i++)
+        out[i] = hist->data[(pos + i) & hist->mask];
+    return (int) len;
+}
+
+bool hist_open(hist_t *hist, const uint8_t *image, uint32_t len, uint32_t *export_s) {
+    if (len < HIST_HEADER_LEN || hist_get32(image) != HIST_MAGIC || image[4] != HIST_VERSION)
+        return false;
+    // Tamanho 0: a máscara cheia lê a imagem sem dar a volta.
+    hist_init(hist, (uint8_t *) &image[HIST_HEADER_LEN], 0, hist_get32(&image[5]), &image[9]);
+    hist->head = len - HIST_HEADER_LEN;
+    *export_s = hist_get32(&image[9 + PET_STATS]);
+    return true;
+}
+
+// ---------------------- Gráfico ----------------------
+
+static void hist_spark_restart(hist_spark_t *spark, const hist_t *hist) {
+    hist_cursor_start(hist, &spark->cursor);
+    memcpy(spark->current, spark->cursor.state.values, PET_STATS);
+    memset(spark->cols, HIST_NONE, sizeof(spark->cols));
+    spark->end_bucket = spark->cursor.state.time_s / spark->bucket_s;
+    for (int i = 0; i < PET_STATS; i++)
+        spark->cols[i][HIST_SPARK_COLS - 1] = spark->current[i];
+}
+
+/**
+ * Desloca as colunas até o instante time_s; as novas repetem os valores
+ * atuais.
+ */
+static bool hist_spark_advance(hist_spark_t *spark, uint32_t time_s) {
+    uint32_t bucket = time_s / spark->bucket_s;
+    if (bucket <= spark->end_bucket)
+        return false;
+    uint32_t shift = bucket - spark->end_bucket;
+    if (shift > HIST_SPARK_COLS)
+        shift = HIST_SPARK_COLS;
+    for (int i = 0; i < PET_STATS; i++) {
+        uint8_t *cols = spark->cols[i];
+        memmove(cols, &cols[shift], HIST_SPARK_COLS - shift);
+        memset(&cols[HIST_SPARK_COLS - shift], spark->current[i], shift);
+    }
+    spark->end_bucket = bucket;
+    return true;
+}
+
+void hist_spark_init(hist_spark_t *spark, const hist_t *hist, uint32_t bucket_s, uint32_t now_s) {
+    spark->bucket_s = bucket_s;
+    hist_spark_restart(spark, hist);
+    hist_spark_update(spark, hist, now_s);
+}
+
+bool hist_spark_update(hist_spark_t *spark, const hist_t *hist, uint32_t now_s) {
+    bool changed = false;
+    hist_entry_t entry;
+    int result;
+    while ((result = hist_cursor_next(hist, &spark->cursor, &entry)) != 0) {
+        if (result < 0) {
+            hist_spark_restart(spark, hist);
+            changed = true;
+            continue;
+        }
+        // Registros atrasados em relação ao gráfico caem na última coluna.
+        changed |= hist_spark_advance(spark, entry.state.time_s);
+        memcpy(spark->current, entry.state.values, PET_STATS);
+        for (int i = 0; i < PET_STATS; i++) {
+            changed |= spark->cols[i][HIST_SPARK_COLS - 1] != spark->current[i];
+            spark->cols[i][HIST_SPARK_COLS - 1] = spark->current[i];
+        }
+    }
+    changed |= hist_spark_advance(spark, now_s);
+    return changed;
+}
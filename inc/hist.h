@@ -0,0 +1,125 @@
+#ifndef HIST_H
+#define HIST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pet.h"
+
+// ---------------------- Histórico dos Atributos ----------------------
+// Anel de bytes com as mudanças dos atributos do Bob em pontos inteiros.
+// Cada registro guarda só a diferença para o anterior: um byte com o tipo e
+// os atributos alterados, o intervalo em segundos em LEB128 e um byte com
+// sinal por atributo alterado, ou um só quando todos variam igual, como num
+// passo de decaimento (3 bytes). Quando o anel enche, os registros mais
+// antigos são descartados e somados ao estado inicial, que fica fora do
+// anel. Cursores decodificam só o que chegou desde a última leitura. O
+// buffer é do chamador. Não depende do pico-sdk.
+
+#define HIST_MAGIC          0x48424F42u     // "BOBH"
+#define HIST_VERSION        1
+#define HIST_HEADER_LEN     17
+#define HIST_RECORD_MAX     (1 + 5 + PET_STATS)
+#define HIST_SPARK_COLS     104             // Colunas de um gráfico
+#define HIST_NONE           0xFF            // Coluna sem dados
+
+enum {
+    HIST_DECAY  = 0,                // Passo de decaimento
+    HIST_CHANGE = 1,                // Ação, partida ou comando
+    HIST_RESET  = 2,                // Bob novo ou início de um traço
+};
+
+typedef struct {
+    uint32_t time_s;
+    uint8_t values[PET_STATS];      // 0-100
+} hist_state_t;
+
+typedef struct {
+    uint8_t *data;
+    uint32_t mask;                  // Tamanho - 1; tamanho em potência de 2
+    uint32_t head, tail;            // Posições contínuas; tail = registro mais antigo
+    hist_state_t first;             // Estado antes do registro em tail
+    hist_state_t last;              // Estado depois do último registro
+    uint32_t records;               // Registros gravados desde o início
+    uint32_t dropped;               // Registros descartados pelo anel cheio
+} hist_t;
+
+typedef struct {
+    uint32_t pos;
+    hist_state_t state;             // Depois do último registro lido
+} hist_cursor_t;
+
+/** Um registro decodificado. */
+typedef struct {
+    uint8_t kind;                   // HIST_*
+    uint8_t changed;                // Um bit por atributo
+    hist_state_t state;             // Depois do registro
+} hist_entry_t;
+
+/**
+ * Começa um histórico vazio em data, com o estado atual. capacity é uma
+ * potência de 2 de pelo menos HIST_RECORD_MAX.
+ */
+void hist_init(hist_t *hist, uint8_t *data, uint32_t capacity, uint32_t time_s,
+               const uint8_t values[PET_STATS]);
+
+/**
+ * Acrescenta um registro se values diferir do último estado, descartando os
+ * mais antigos se faltar espaço. Um time_s anterior ao último registro fica
+ * com o instante dele. Retorna true se gravou.
+ */
+bool hist_append(hist_t *hist, uint8_t kind, uint32_t time_s, const uint8_t values[PET_STATS]);
+
+/** Posiciona o cursor no registro mais antigo. */
+void hist_cursor_start(const hist_t *hist, hist_cursor_t *cursor);
+
+/**
+ * Próximo registro. Retorna 1 com um registro, 0 no fim e -1 se o anel já
+ * descartou a posição do cursor; nesse caso, recomece com
+ * hist_cursor_start().
+ */
+int hist_cursor_next(const hist_t *hist, hist_cursor_t *cursor, hist_entry_t *entry);
+
+// ---------------------- Exportação ----------------------
+// Imagem linear: cabeçalho (HIST_HEADER_LEN bytes, com first e o instante
+// da exportação) seguido dos registros em ordem, de tail a head.
+
+/** Escreve o cabeçalho da imagem. Retorna o tamanho. */
+uint32_t hist_export_header(const hist_t *hist, uint32_t now_s, uint8_t *out);
+
+/**
+ * Copia até len bytes do anel a partir da posição pos, sem passar de head.
+ * Retorna o número de bytes (0 em head), ou -1 se pos já foi descartada.
+ */
+int hist_copy(const hist_t *hist, uint32_t pos, uint8_t *out, uint32_t len);
+
+/**
+ * Abre uma imagem para leitura com os cursores. O hist_t aponta para a
+ * imagem e não deve receber registros. Retorna false se não for uma imagem
+ * desta versão.
+ */
+bool hist_open(hist_t *hist, const uint8_t *image, uint32_t len, uint32_t *export_s);
+
+// ---------------------- Gráfico ----------------------
+// Último valor de cada atributo em colunas de bucket_s segundos, com a
+// última coluna no instante atual. A atualização decodifica só os
+// registros novos e desloca as colunas conforme o tempo passa.
+
+typedef struct {
+    hist_cursor_t cursor;
+    uint32_t bucket_s;
+    uint32_t end_bucket;            // Coluna mais à direita (tempo / bucket_s)
+    uint8_t current[PET_STATS];     // Valores desde o último registro lido
+    uint8_t cols[PET_STATS][HIST_SPARK_COLS];
+} hist_spark_t;
+
+/** Prepara o gráfico lendo o histórico inteiro uma vez. */
+void hist_spark_init(hist_spark_t *spark, const hist_t *hist, uint32_t bucket_s, uint32_t now_s);
+
+/**
+ * Lê os registros novos e avança até now_s. Retorna true se alguma coluna
+ * mudou.
+ */
+bool hist_spark_update(hist_spark_t *spark, const hist_t *hist, uint32_t now_s);
+
+#endif
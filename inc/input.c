@@ -0,0 +1,54 @@
+#include "input.h"
+#include <stddef.h>
+
+static input_queue_t *queues[INPUT_MAX_QUEUES];
+static uint32_t queue_count = 0;
+
+void input_queue_init(input_queue_t *queue) {
+    queue->head = 0;
+    queue->tail = 0;
+    queue->dropped = 0;
+}
+
+bool input_queue_push(input_queue_t *queue, input_t type, input_source_t source,
+                      uint32_t time_us) {
+    uint32_t head = queue->head;
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= INPUT_QUEUE_LEN) {
+        queue->dropped++;
+        return false;
+    }
+    input_event_t *event = &queue->events[head % INPUT_QUEUE_LEN];
+    event->type = type;
+    event->source = source;
+    event->time_us = time_us;
+    // O evento fica visível ao consumidor só depois de escrito por inteiro.
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool input_attach(input_queue_t *queue) {
+    if (queue_count >= INPUT_MAX_QUEUES)
+        return false;
+    queues[queue_count++] = queue;
+    return true;
+}
+
+bool input_poll(input_event_t *event) {
+    input_queue_t *oldest = NULL;
+    for (uint32_t i = 0; i < queue_count; i++) {
+        input_queue_t *queue = queues[i];
+        uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+        if (head == queue->tail)
+            continue;
+        if (oldest == NULL ||
+            (int32_t)(queue->events[queue->tail % INPUT_QUEUE_LEN].time_us -
+                      oldest->events[oldest->tail % INPUT_QUEUE_LEN].time_us) < 0)
+            oldest = queue;
+    }
+    if (oldest == NULL)
+        return false;
+    *event = oldest->events[oldest->tail % INPUT_QUEUE_LEN];
+    __atomic_store_n(&oldest->tail, oldest->tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
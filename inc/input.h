@@ -0,0 +1,68 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ---------------------- Eventos de Entrada ----------------------
+// Cada fonte (joystick, botões...) publica em sua própria fila SPSC, escrita
+// apenas pela interrupção da fonte e lida apenas pelo laço principal. O
+// consumidor intercala as filas por ordem de tempo em input_poll().
+
+typedef enum {
+    INPUT_NONE = 0,
+    INPUT_LEFT,
+    INPUT_RIGHT,
+    INPUT_UP,
+    INPUT_DOWN,
+    INPUT_PRESS,
+    INPUT_RELEASE,
+    INPUT_LONG_PRESS,
+    INPUT_DOUBLE_PRESS,     // Publicado junto com o segundo INPUT_PRESS
+    INPUT_BACK              // Ação "voltar" (botão extra)
+} input_t;
+
+typedef enum {
+    INPUT_SRC_JOYSTICK = 0,
+    INPUT_SRC_BUTTON,       // BUTTON_PIN
+    INPUT_SRC_ERASE,        // ERASE_BUTTON_PIN
+    INPUT_SRC_LINK,         // Injetada pela USB (LINK_CMD_INPUT)
+    INPUT_SRC_REPLAYED = 0x80   // Somada à fonte original de um evento reproduzido
+} input_source_t;
+
+typedef struct {
+    uint8_t type;           // input_t
+    uint8_t source;         // input_source_t
+    uint32_t time_us;       // Instante da detecção (time_us_32)
+} input_event_t;
+
+#define INPUT_QUEUE_LEN     32      // Potência de 2
+#define INPUT_MAX_QUEUES    8       // Joystick, botões, USB, traço e folga
+
+typedef struct {
+    input_event_t events[INPUT_QUEUE_LEN];
+    uint32_t head;          // Escrito só pelo produtor
+    uint32_t tail;          // Escrito só pelo consumidor
+    uint32_t dropped;       // Eventos perdidos por fila cheia
+} input_queue_t;
+
+void input_queue_init(input_queue_t *queue);
+
+/**
+ * Publica um evento (lado produtor). Retorna false se a fila estiver cheia.
+ */
+bool input_queue_push(input_queue_t *queue, input_t type, input_source_t source,
+                      uint32_t time_us);
+
+/**
+ * Registra uma fila para ser lida por input_poll(). Retorna false se já
+ * houver INPUT_MAX_QUEUES filas.
+ */
+bool input_attach(input_queue_t *queue);
+
+/**
+ * Retira o evento mais antigo entre todas as filas registradas.
+ */
+bool input_poll(input_event_t *event);
+
+#endif
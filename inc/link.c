@@ -0,0 +1,178 @@
+#include <string.h>
+
+#include "link.h"
+
+uint32_t link_ring_used(const link_ring_t *ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+uint32_t link_ring_free(const link_ring_t *ring) {
+    return LINK_RING_LEN - link_ring_used(ring);
+}
+
+uint32_t link_ring_write(link_ring_t *ring, const uint8_t *data, uint32_t len) {
+    uint32_t head = ring->head;
+    uint32_t room = LINK_RING_LEN - (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE));
+    if (len > room)
+        len = room;
+    for (uint32_t i = 0; i < len; i++)
+        ring->bytes[(head + i) % LINK_RING_LEN] = data[i];
+    // Os bytes ficam visíveis ao consumidor só depois de escritos.
+    __atomic_store_n(&ring->head, head + len, __ATOMIC_RELEASE);
+    return len;
+}
+
+uint32_t link_ring_peek(const link_ring_t *ring, const uint8_t **data) {
+    uint32_t tail = ring->tail;
+    uint32_t used = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail;
+    uint32_t offset = tail % LINK_RING_LEN;
+    *data = &ring->bytes[offset];
+    return used < LINK_RING_LEN - offset ? used : LINK_RING_LEN - offset;
+}
+
+void link_ring_consume(link_ring_t *ring, uint32_t len) {
+    __atomic_store_n(&ring->tail, ring->tail + len, __ATOMIC_RELEASE);
+}
+
+static uint16_t link_crc16(const uint8_t *data, uint32_t len) {
+    uint16_t crc = 0xFFFF;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)(data[i] << 8);
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+uint32_t link_encode(uint8_t type, uint8_t seq, const void *payload, uint32_t len, uint8_t *out) {
+    uint8_t raw[LINK_FRAME_MAX];
+    if (len > LINK_PAYLOAD_MAX)
+        len = LINK_PAYLOAD_MAX;
+    raw[0] = type;
+    raw[1] = seq;
+    if (len > 0)
+        memcpy(&raw[2], payload, len);
+    uint16_t crc = link_crc16(raw, len + 2);
+    link_put16(&raw[len + 2], crc);
+    uint32_t raw_len = len + 4;
+
+    // COBS: cada bloco começa com a distância até o próximo zero.
+    uint32_t n = 0;
+    out[n++] = 0;
+    uint32_t code_at = n++;
+    uint8_t code = 1;
+    for (uint32_t i = 0; i < raw_len; i++) {
+        if (raw[i] != 0) {
+            out[n++] = raw[i];
+            code++;
+        }
+        if (raw[i] == 0 || code == 0xFF) {
+            out[code_at] = code;
+            code_at = n++;
+            code = 1;
+        }
+    }
+    out[code_at] = code;
+    out[n++] = 0;
+    return n;
+}
+
+static bool link_decode(const uint8_t *in, uint32_t len, link_frame_t *frame) {
+    uint8_t raw[LINK_FRAME_MAX];
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < len;) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len)
+            return false;
+        for (uint8_t k = 1; k < code; k++) {
+            if (n == sizeof(raw))
+                return false;
+            raw[n++] = in[i++];
+        }
+        if (code != 0xFF && i < len) {
+            if (n == sizeof(raw))
+                return false;
+            raw[n++] = 0;
+        }
+    }
+    if (n < 4 || link_crc16(raw, n - 2) != link_get16(&raw[n - 2]))
+        return false;
+    frame->type = raw[0];
+    frame->seq = raw[1];
+    frame->len = (uint8_t)(n - 4);
+    memcpy(frame->payload, &raw[2], frame->len);
+    return true;
+}
+
+int link_parse(link_parser_t *parser, uint8_t byte, link_frame_t *frame) {
+    if (byte != 0) {
+        if (parser->len < sizeof(parser->buf))
+            parser->buf[parser->len++] = byte;
+        else
+            parser->overflow = true;
+        return 0;
+    }
+    // Zeros seguidos (fim de um quadro e início do próximo) não são erro.
+    if (parser->len == 0)
+        return 0;
+    bool ok = !parser->overflow && link_decode(parser->buf, parser->len, frame);
+    parser->len = 0;
+    parser->overflow = false;
+    return ok ? 1 : -1;
+}
+
+void link_init(link_t *link) {
+    memset(link, 0, sizeof(*link));
+}
+
+bool link_send(link_t *link, uint8_t type, const void *payload, uint32_t len) {
+    uint8_t wire[LINK_WIRE_MAX];
+    uint32_t n = link_encode(type, link->seq++, payload, len, wire);
+    // Tudo ou nada: um quadro pela metade estragaria o seguinte. A sequência
+    // avança mesmo assim, para o PC perceber o buraco.
+    if (link_ring_free(&link->tx) < n) {
+        link->stats.tx_dropped++;
+        return false;
+    }
+    link_ring_write(&link->tx, wire, n);
+    link->stats.tx_frames++;
+    return true;
+}
+
+bool link_receive(link_t *link, link_frame_t *frame) {
+    const uint8_t *data;
+    uint32_t len;
+    while ((len = link_ring_peek(&link->rx, &data)) > 0) {
+        for (uint32_t i = 0; i < len; i++) {
+            int result = link_parse(&link->parser, data[i], frame);
+            if (result < 0)
+                link->stats.rx_errors++;
+            if (result > 0) {
+                link->stats.rx_frames++;
+                link_ring_consume(&link->rx, i + 1);
+                return true;
+            }
+        }
+        link_ring_consume(&link->rx, len);
+    }
+    return false;
+}
+
+uint8_t *link_put16(uint8_t *p, uint16_t value) {
+    p[0] = (uint8_t) value;
+    p[1] = (uint8_t)(value >> 8);
+    return p + 2;
+}
+
+uint8_t *link_put32(uint8_t *p, uint32_t value) {
+    return link_put16(link_put16(p, (uint16_t) value), (uint16_t)(value >> 16));
+}
+
+uint16_t link_get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+uint32_t link_get32(const uint8_t *p) {
+    return link_get16(p) | (uint32_t) link_get16(p + 2) << 16;
+}
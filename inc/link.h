@@ -0,0 +1,149 @@
+#ifndef LINK_H
+#define LINK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ---------------------- Protocolo Binário pela USB ----------------------
+// Cada quadro leva tipo, número de sequência, até LINK_PAYLOAD_MAX bytes e um
+// CRC-16/CCITT, codificados em COBS e cercados por bytes 0x00. O zero
+// inicial separa o quadro do resto de um quadro cortado, como o de um PC
+// que abriu a porta no meio do fluxo. Os dois sentidos passam por anéis SPSC
+// de bytes: quem gera um quadro nunca espera pelo USB, e um quadro que não
+// cabe é descartado inteiro. Não depende do pico-sdk; o decodificador do PC
+// usa o mesmo código.
+
+#define LINK_PAYLOAD_MAX    96
+#define LINK_FRAME_MAX      (LINK_PAYLOAD_MAX + 4)          // Tipo, sequência e CRC
+#define LINK_WIRE_MAX       (LINK_FRAME_MAX + LINK_FRAME_MAX / 254 + 3)
+#define LINK_RING_LEN       1024                            // Potência de 2
+
+// Firmware -> PC
+enum {
+    LINK_TELEMETRY  = 0x01,         // Estado do Bob (LINK_TM_*)
+    LINK_PROFILE    = 0x02,         // Um trecho do perfil (LINK_PF_*)
+    LINK_ACK        = 0x03,         // u8 sequência e u8 tipo do comando, u8 resultado
+    LINK_TRACE      = 0x04,         // u16 posição e um trecho do traço; vazio no fim
+    LINK_HISTORY    = 0x05,         // u16 posição e um trecho do histórico (inc/hist.h);
+                                    // vazio no fim, posição 0 recomeça
+    LINK_TEXT       = 0x06,         // Relatório em texto, sem terminador
+};
+
+// Deslocamentos na telemetria (little-endian).
+#define LINK_TM_UPTIME      0       // u32 ms desde o boot
+#define LINK_TM_STATS       4       // 4 x u16: fome, higiene, energia, diversão (Q8)
+#define LINK_TM_NEXT_STEP   12      // u32 ms até o próximo decaimento
+#define LINK_TM_UI          16      // u8 tela, u8 menu, u8 item selecionado, u8 dificuldade
+#define LINK_TM_BOARD       20      // 2 x u32: casas do jogador e do Bob (inc/mnk.h)
+#define LINK_TM_FLAGS       28      // u8: bit 0 modo ocioso, bit 1 vez do jogador,
+                                    // bit 2 gravando, bit 3 reproduzindo
+#define LINK_TM_TX_DROPPED  30      // u32
+#define LINK_TM_RX_ERRORS   34      // u32
+#define LINK_TM_LEN         38
+
+// Deslocamentos num trecho do perfil.
+#define LINK_PF_ID          0       // u8
+#define LINK_PF_COUNT       1       // u32
+#define LINK_PF_MIN         5       // u32 us
+#define LINK_PF_MAX         9       // u32 us
+#define LINK_PF_TOTAL       13      // u32 baixo, u32 alto (us)
+#define LINK_PF_HIST        21      // 16 x u32
+#define LINK_PF_NAME        85      // Nome terminado em zero (até 10 caracteres)
+
+// PC -> firmware
+enum {
+    LINK_CMD_RATE     = 0x10,       // u16 período da telemetria em ms (0 = parada)
+    LINK_CMD_SET_STAT = 0x11,       // u8 atributo, u8 valor (0-100)
+    LINK_CMD_INPUT    = 0x12,       // u8 input_t, entregue como entrada comum
+    LINK_CMD_ACTION   = 0x13,       // u8 menu (0 = principal, 1 = alimentar, 2 = brincar), u8 item
+    LINK_CMD_PROFILE  = 0x14,       // u8 0 = enviar os trechos, 1 = zerar
+    LINK_CMD_TRACE    = 0x15,       // u8 operação (LINK_TRACE_*) e argumentos
+    LINK_CMD_HISTORY  = 0x16,       // Envia o histórico dos atributos em quadros LINK_HISTORY
+};
+
+// Operações de LINK_CMD_TRACE (inc/trace.h).
+enum {
+    LINK_TRACE_RECORD = 0,          // Começa a gravar no menu principal
+    LINK_TRACE_STOP   = 1,          // Para e envia o traço em quadros LINK_TRACE
+    LINK_TRACE_LOAD   = 2,          // u16 posição e um trecho do traço a reproduzir
+    LINK_TRACE_PLAY   = 3,          // Reproduz o traço carregado
+};
+
+#define LINK_TRACE_CHUNK    (LINK_PAYLOAD_MAX - 3)      // Cabe num LINK_TRACE_LOAD
+#define LINK_HISTORY_CHUNK  (LINK_PAYLOAD_MAX - 2)
+
+enum { LINK_OK = 0, LINK_BAD_COMMAND, LINK_BAD_ARGUMENT, LINK_BUSY };
+
+typedef struct {
+    uint8_t type;
+    uint8_t seq;
+    uint8_t len;
+    uint8_t payload[LINK_PAYLOAD_MAX];
+} link_frame_t;
+
+typedef struct {
+    uint8_t bytes[LINK_RING_LEN];
+    uint32_t head;                  // Escrito só pelo produtor
+    uint32_t tail;                  // Escrito só pelo consumidor
+} link_ring_t;
+
+/** Acumula bytes recebidos até um 0x00 e decodifica o quadro. */
+typedef struct {
+    uint8_t buf[LINK_WIRE_MAX];
+    uint32_t len;
+    bool overflow;
+} link_parser_t;
+
+typedef struct {
+    uint32_t tx_frames;
+    uint32_t tx_dropped;            // Quadros que não couberam no anel
+    uint32_t rx_frames;
+    uint32_t rx_errors;             // Trechos entre zeros que não são quadros
+} link_stats_t;
+
+typedef struct {
+    link_ring_t tx, rx;
+    link_parser_t parser;
+    uint8_t seq;
+    link_stats_t stats;
+} link_t;
+
+// Anel de bytes: um produtor e um consumidor, cada um em seu contexto.
+uint32_t link_ring_used(const link_ring_t *ring);
+uint32_t link_ring_free(const link_ring_t *ring);
+uint32_t link_ring_write(link_ring_t *ring, const uint8_t *data, uint32_t len);
+
+/**
+ * Trecho contíguo pronto para leitura, sem consumi-lo; link_ring_consume()
+ * libera os bytes depois de enviados.
+ */
+uint32_t link_ring_peek(const link_ring_t *ring, const uint8_t **data);
+void link_ring_consume(link_ring_t *ring, uint32_t len);
+
+/**
+ * Codifica um quadro completo (zeros das pontas incluídos) em out, que deve
+ * ter LINK_WIRE_MAX bytes. Retorna o tamanho.
+ */
+uint32_t link_encode(uint8_t type, uint8_t seq, const void *payload, uint32_t len, uint8_t *out);
+
+/**
+ * Alimenta o decodificador com um byte. Retorna 1 com um quadro válido em
+ * frame, -1 ao descartar um trecho inválido e 0 no meio de um quadro.
+ */
+int link_parse(link_parser_t *parser, uint8_t byte, link_frame_t *frame);
+
+void link_init(link_t *link);
+
+/** Enfileira um quadro para envio; sem espaço, descarta e retorna false. */
+bool link_send(link_t *link, uint8_t type, const void *payload, uint32_t len);
+
+/** Retira o próximo quadro recebido do anel de entrada. */
+bool link_receive(link_t *link, link_frame_t *frame);
+
+// Campos little-endian. Cada put retorna o ponteiro após o campo.
+uint8_t *link_put16(uint8_t *p, uint16_t value);
+uint8_t *link_put32(uint8_t *p, uint32_t value);
+uint16_t link_get16(const uint8_t *p);
+uint32_t link_get32(const uint8_t *p);
+
+#endif
@@ -0,0 +1,314 @@
+#include <string.h>
+
+#include "mnk.h"
+
+// O custo de um nó cresce com as linhas do tabuleiro (a avaliação percorre
+// todas), então o teto é de nós x linhas. Sem medição no alvo, a conta é
+// por instruções: no M0+ a 125 MHz, um nó do 5x5 (28 linhas) fica em torno
+// de 1500 ciclos, ou 12 us, com a avaliação em ~25 ciclos por linha e a
+// ordenação dos lances. Os tetos ficam em 1/4 a 1/5 do prazo nessa conta,
+// para que a jogada dependa só do teto, e não do relógio, e a reprodução de
+// um traço repita a partida: 5x5 difícil com 1714 nós (~21 ms de 100),
+// normal com 428 (~5 ms de 20). No difícil, o 3x3 (8 linhas, 6000 nós) é
+// resolvido por inteiro antes do teto; host/tools/mnkbench.c confere.
+const mnk_level_t mnk_levels[MNK_LEVELS] = {
+    [MNK_EASY]   = {.max_depth = 1, .random_pct = 50, .max_work = 1600,  .budget_us = 5000},
+    [MNK_NORMAL] = {.max_depth = 4, .random_pct = 10, .max_work = 12000, .budget_us = 20000},
+    [MNK_HARD]   = {.max_depth = MNK_MAX_CELLS, .random_pct = 0, .max_work = 48000,
+                    .budget_us = 100000},
+};
+
+enum { BOUND_EXACT = 0, BOUND_LOWER = 1, BOUND_UPPER = 2 };
+
+#define MNK_INF         (MNK_WIN + 1)
+#define MNK_DECIDED     (MNK_WIN - MNK_MAX_CELLS)  // Acima disso, resultado forçado
+#define MNK_EVAL_MAX    (MNK_DECIDED / 2)
+#define MNK_CLOCK_NODES 256                         // Nós entre consultas ao relógio
+
+// Peso de uma linha ainda aberta para um só jogador, pelo número de casas dele.
+static const int16_t line_weight[MNK_MAX_K] = {0, 1, 4, 16, 64};
+
+/**
+ * Bits ligados numa máscara de casas. O M0+ não tem popcount em hardware, e
+ * com as poucas casas de uma linha o laço sobre os bits ligados sai mais
+ * barato que a chamada à biblioteca.
+ */
+static int bit_count(uint32_t bits) {
+    int count = 0;
+    for (; bits != 0; bits &= bits - 1)
+        count++;
+    return count;
+}
+
+bool mnk_rules_init(mnk_rules_t *rules, int width, int height, int k) {
+    if (width < 1 || height < 1 || width * height > MNK_MAX_CELLS || k < 2 || k > MNK_MAX_K ||
+        (k > width && k > height))
+        return false;
+    memset(rules, 0, sizeof(*rules));
+    rules->width = (uint8_t) width;
+    rules->height = (uint8_t) height;
+    rules->k = (uint8_t) k;
+    rules->cells = (uint8_t)(width * height);
+    rules->full = rules->cells == 32 ? UINT32_MAX : (1u << rules->cells) - 1;
+
+    // Direita, baixo, diagonal e antidiagonal, a partir de cada casa.
+    static const int8_t steps[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            for (int d = 0; d < 4; d++) {
+                int end_row = row + steps[d][0] * (k - 1), end_col = col + steps[d][1] * (k - 1);
+                if (end_row >= height || end_col < 0 || end_col >= width)
+                    continue;
+                uint32_t line = 0;
+                for (int i = 0; i < k; i++)
+                    line |= 1u << ((row + steps[d][0] * i) * width + col + steps[d][1] * i);
+                uint8_t index = rules->line_count++;
+                rules->lines[index] = line;
+                for (int cell = 0; cell < rules->cells; cell++)
+                    if ((line >> cell) & 1)
+                        rules->cell_lines[cell][rules->cell_line_count[cell]++] = index;
+            }
+        }
+    }
+
+    // Casas em mais linhas primeiro (o centro no 3x3); empates na ordem das casas.
+    for (int cell = 0; cell < rules->cells; cell++) {
+        int i = cell;
+        uint8_t lines = rules->cell_line_count[cell];
+        for (; i > 0 && rules->cell_line_count[rules->order[i - 1]] < lines; i--)
+            rules->order[i] = rules->order[i - 1];
+        rules->order[i] = (uint8_t) cell;
+    }
+    return true;
+}
+
+/**
+ * Indica se a máscara completa alguma linha que passa pela casa.
+ */
+static bool wins_at(const mnk_rules_t *rules, uint32_t mask, int cell) {
+    for (int i = 0; i < rules->cell_line_count[cell]; i++) {
+        uint32_t line = rules->lines[rules->cell_lines[cell][i]];
+        if ((mask & line) == line)
+            return true;
+    }
+    return false;
+}
+
+int mnk_winner(const mnk_rules_t *rules, const mnk_board_t *board) {
+    for (int i = 0; i < rules->line_count; i++) {
+        uint32_t line = rules->lines[i];
+        if ((board->mask[0] & line) == line)
+            return 1;
+        if ((board->mask[1] & line) == line)
+            return 2;
+    }
+    if ((board->mask[0] | board->mask[1]) == rules->full)
+        return -1;
+    return 0;
+}
+
+static uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void mnk_engine_init(mnk_engine_t *engine) {
+    // Semente fixa: as mesmas chaves em todo boot, e buscas reprodutíveis.
+    uint64_t state = 0x426F62;
+    for (int side = 0; side < 2; side++)
+        for (int cell = 0; cell < MNK_MAX_CELLS; cell++)
+            engine->zobrist[side][cell] = splitmix64(&state);
+    mnk_engine_clear(engine);
+}
+
+void mnk_engine_clear(mnk_engine_t *engine) {
+    memset(engine->tt, 0, sizeof(engine->tt));
+    memset(engine->history, 0, sizeof(engine->history));
+}
+
+/**
+ * Avaliação estática para quem joga: linhas abertas só para um dos lados,
+ * pesadas pelo número de casas já marcadas.
+ */
+static int evaluate(const mnk_rules_t *rules, uint32_t me, uint32_t opp) {
+    int score = 0;
+    for (int i = 0; i < rules->line_count; i++) {
+        uint32_t line = rules->lines[i];
+        uint32_t mine = me & line, theirs = opp & line;
+        if (mine == 0)
+            score -= line_weight[bit_count(theirs)];
+        else if (theirs == 0)
+            score += line_weight[bit_count(mine)];
+    }
+    if (score > MNK_EVAL_MAX)
+        return MNK_EVAL_MAX;
+    return score < -MNK_EVAL_MAX ? -MNK_EVAL_MAX : score;
+}
+
+// Placares de vitória forçada ficam na tabela relativos ao nó, não à raiz.
+static int score_to_tt(int score, int ply) {
+    return score >= MNK_DECIDED ? score + ply : score <= -MNK_DECIDED ? score - ply : score;
+}
+
+static int score_from_tt(int score, int ply) {
+    return score >= MNK_DECIDED ? score - ply : score <= -MNK_DECIDED ? score + ply : score;
+}
+
+static bool out_of_budget(mnk_engine_t *e) {
+    if (e->nodes >= e->max_nodes)
+        return true;
+    if (e->clock != NULL && e->nodes % MNK_CLOCK_NODES == 0 &&
+        (int32_t)(e->clock() - e->deadline_us) >= 0) {
+        e->timeout = true;
+        return true;
+    }
+    return false;
+}
+
+static int negamax(mnk_engine_t *e, uint32_t me, uint32_t opp, uint64_t key, int side,
+                   int depth, int ply, int alpha, int beta) {
+    const mnk_rules_t *rules = e->rules;
+    e->nodes++;
+    if (e->aborted || (e->aborted = out_of_budget(e)))
+        return 0;
+    uint32_t free_cells = rules->full & ~(me | opp);
+    if (free_cells == 0)
+        return 0;
+    if (depth == 0)
+        return evaluate(rules, me, opp);
+
+    mnk_tt_entry_t *entry = &e->tt[key & (MNK_TT_LEN - 1)];
+    int tt_move = -1;
+    if (entry->check == (uint32_t)(key >> 32) && entry->depth != 0) {
+        tt_move = entry->bound_move >> 2;
+        int score = score_from_tt(entry->score, ply);
+        int bound = entry->bound_move & 3;
+        if (entry->depth >= depth && ply > 0) {
+            if (bound == BOUND_EXACT)
+                return score;
+            if (bound == BOUND_LOWER && score > alpha)
+                alpha = score;
+            else if (bound == BOUND_UPPER && score < beta)
+                beta = score;
+            if (alpha >= beta)
+                return score;
+        }
+    }
+
+    // Lance da tabela primeiro, depois os que mais cortaram; empates ficam na
+    // ordem das regras.
+    uint8_t moves[MNK_MAX_CELLS];
+    uint32_t keys[MNK_MAX_CELLS];
+    int count = 0;
+    for (int i = 0; i < rules->cells; i++) {
+        int cell = rules->order[i];
+        if (!((free_cells >> cell) & 1))
+            continue;
+        uint32_t sort_key = cell == tt_move ? UINT32_MAX : e->history[cell];
+        int j = count++;
+        for (; j > 0 && keys[j - 1] < sort_key; j--) {
+            moves[j] = moves[j - 1];
+            keys[j] = keys[j - 1];
+        }
+        moves[j] = (uint8_t) cell;
+        keys[j] = sort_key;
+    }
+
+    int alpha_start = alpha;
+    int best = -MNK_INF, best_move = -1;
+    for (int i = 0; i < count; i++) {
+        int cell = moves[i];
+        uint32_t next = me | 1u << cell;
+        int score;
+        if (wins_at(rules, next, cell))
+            score = MNK_WIN - (ply + 1);
+        else
+            score = -negamax(e, opp, next, key ^ e->zobrist[side][cell], side ^ 1,
+                             depth - 1, ply + 1, -beta, -alpha);
+        if (e->aborted)
+            return 0;
+        if (score > best) {
+            best = score;
+            best_move = cell;
+        }
+        if (score > alpha)
+            alpha = score;
+        if (alpha >= beta) {
+            uint32_t bonus = e->history[cell] + (uint32_t)(depth * depth);
+            e->history[cell] = bonus > UINT16_MAX ? UINT16_MAX : (uint16_t) bonus;
+            break;
+        }
+    }
+
+    int bound = best <= alpha_start ? BOUND_UPPER : best >= beta ? BOUND_LOWER : BOUND_EXACT;
+    // Substitui a entrada, exceto uma mais profunda de outra posição.
+    if (entry->check == (uint32_t)(key >> 32) || entry->depth <= depth) {
+        entry->check = (uint32_t)(key >> 32);
+        entry->score = (int16_t) score_to_tt(best, ply);
+        entry->depth = (uint8_t) depth;
+        entry->bound_move = (uint8_t)(best_move << 2 | bound);
+    }
+    if (ply == 0)
+        e->root_move = (int8_t) best_move;
+    return best;
+}
+
+int mnk_search(mnk_engine_t *engine, const mnk_rules_t *rules, const mnk_board_t *board,
+               int player, const mnk_level_t *level, uint32_t random, mnk_clock_fn clock,
+               mnk_result_t *result) {
+    memset(result, 0, sizeof(*result));
+    result->move = -1;
+    uint32_t free_cells = mnk_free_mask(rules, board);
+    int empty = bit_count(free_cells);
+    if (empty == 0)
+        return -1;
+
+    if (random % 100 < level->random_pct) {
+        int n = (int)(random / 100 % (uint32_t) empty);
+        for (int cell = 0; cell < rules->cells; cell++)
+            if (((free_cells >> cell) & 1) && n-- == 0)
+                result->move = (int8_t) cell;
+        result->random = true;
+        return result->move;
+    }
+
+    engine->rules = rules;
+    engine->nodes = 0;
+    engine->max_nodes = level->max_work / rules->line_count;
+    engine->clock = level->budget_us != 0 ? clock : NULL;
+    engine->deadline_us = engine->clock != NULL ? clock() + level->budget_us : 0;
+    engine->aborted = false;
+    engine->timeout = false;
+
+    int side = player - 1;
+    uint32_t me = board->mask[side], opp = board->mask[side ^ 1];
+    uint64_t key = 0;
+    for (int cell = 0; cell < rules->cells; cell++) {
+        if ((board->mask[0] >> cell) & 1)
+            key ^= engine->zobrist[0][cell];
+        if ((board->mask[1] >> cell) & 1)
+            key ^= engine->zobrist[1][cell];
+    }
+
+    // Sem nenhuma profundidade completa, fica a casa em mais linhas.
+    for (int i = 0; i < rules->cells && result->move < 0; i++)
+        if ((free_cells >> rules->order[i]) & 1)
+            result->move = (int8_t) rules->order[i];
+
+    int max_depth = level->max_depth < empty ? level->max_depth : empty;
+    for (int depth = 1; depth <= max_depth; depth++) {
+        int score = negamax(engine, me, opp, key, side, depth, 0, -MNK_INF, MNK_INF);
+        if (engine->aborted)
+            break;
+        result->move = engine->root_move;
+        result->score = (int16_t) score;
+        result->depth = (uint8_t) depth;
+        if (score >= MNK_DECIDED || score <= -MNK_DECIDED)
+            break;
+    }
+    result->nodes = engine->nodes;
+    result->timeout = engine->timeout;
+    return result->move;
+}
@@ -0,0 +1,151 @@
+#ifndef MNK_H
+#define MNK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ---------------------- Jogo m,n,k e Oponente ----------------------
+// Tabuleiro de width x height casas em que vence quem completar k em linha
+// (horizontal, vertical ou diagonal); o Jogo da Velha é o 3,3,3. Cada
+// jogador é uma máscara de até 32 bits, com a casa (linha, coluna) no bit
+// linha * width + coluna.
+//
+// O oponente é um negamax com poda alfa-beta e aprofundamento iterativo.
+// Os lances são ordenados pelo melhor lance da tabela de transposição, pelo
+// histórico de cortes e pelo número de linhas que passam pela casa. A tabela
+// usa chaves de Zobrist e fica numa área fixa dentro de mnk_engine_t. Cada
+// nível limita a profundidade, os nós e o tempo por jogada. O teto de nós
+// torna a escolha reprodutível; o prazo é o limite rígido que impede a busca
+// de segurar o laço principal. Não depende do pico-sdk.
+
+#define MNK_MAX_CELLS   32
+#define MNK_MAX_K       5
+#define MNK_MAX_LINES   (4 * MNK_MAX_CELLS)     // Uma por casa inicial e direção
+#define MNK_CELL_LINES  (4 * MNK_MAX_K)         // Linhas que passam por uma casa
+#define MNK_TT_BITS     10
+#define MNK_TT_LEN      (1u << MNK_TT_BITS)     // 8 KB
+#define MNK_WIN         10000                   // Vitória no lance atual; menos o número de lances
+
+typedef struct {
+    uint8_t width, height, k;
+    uint8_t cells;
+    uint8_t line_count;
+    uint32_t full;                          // Todas as casas
+    uint32_t lines[MNK_MAX_LINES];          // Máscaras de k casas em linha
+    uint8_t cell_line_count[MNK_MAX_CELLS];
+    uint8_t cell_lines[MNK_MAX_CELLS][MNK_CELL_LINES];  // Índices em lines[]
+    uint8_t order[MNK_MAX_CELLS];           // Casas em mais linhas primeiro
+} mnk_rules_t;
+
+typedef struct {
+    uint32_t mask[2];                       // mask[0] = jogador 1, mask[1] = jogador 2 (Bob)
+} mnk_board_t;
+
+/** Limites de um nível de força. */
+typedef struct {
+    uint8_t max_depth;                      // Lances à frente
+    uint8_t random_pct;                     // Chance de jogar numa casa livre ao acaso
+    uint32_t max_work;                      // Teto de nós x linhas do tabuleiro por jogada
+    uint32_t budget_us;                     // Prazo por jogada (0 = sem prazo)
+} mnk_level_t;
+
+enum { MNK_EASY, MNK_NORMAL, MNK_HARD, MNK_LEVELS };
+
+extern const mnk_level_t mnk_levels[MNK_LEVELS];
+
+typedef struct {
+    uint32_t check;                         // Parte alta da chave
+    int16_t score;
+    uint8_t depth;
+    uint8_t bound_move;                     // Tipo do limite (2 bits) e melhor lance (6 bits)
+} mnk_tt_entry_t;
+
+/** Relógio em microssegundos, para o prazo. */
+typedef uint32_t (*mnk_clock_fn)(void);
+
+typedef struct {
+    int8_t move;                            // -1 sem casa livre
+    int16_t score;                          // Para quem joga; perto de ±MNK_WIN = resultado forçado
+    uint8_t depth;                          // Última profundidade completa
+    bool random;                            // Lance ao acaso do nível
+    bool timeout;                           // A busca parou pelo prazo
+    uint32_t nodes;
+} mnk_result_t;
+
+typedef struct {
+    uint64_t zobrist[2][MNK_MAX_CELLS];
+    mnk_tt_entry_t tt[MNK_TT_LEN];
+    uint16_t history[MNK_MAX_CELLS];
+
+    // Busca em curso.
+    const mnk_rules_t *rules;
+    uint32_t nodes, max_nodes;
+    uint32_t deadline_us;
+    mnk_clock_fn clock;
+    bool aborted, timeout;
+    int8_t root_move;
+} mnk_engine_t;
+
+/**
+ * Prepara as regras; falha se o tabuleiro passar de MNK_MAX_CELLS casas ou
+ * k não couber nele.
+ */
+bool mnk_rules_init(mnk_rules_t *rules, int width, int height, int k);
+
+static inline int mnk_cell(const mnk_rules_t *rules, int row, int col) {
+    return row * rules->width + col;
+}
+
+static inline void mnk_reset(mnk_board_t *board) {
+    board->mask[0] = 0;
+    board->mask[1] = 0;
+}
+
+static inline uint32_t mnk_free_mask(const mnk_rules_t *rules, const mnk_board_t *board) {
+    return rules->full & ~(board->mask[0] | board->mask[1]);
+}
+
+static inline bool mnk_is_free(const mnk_rules_t *rules, const mnk_board_t *board, int cell) {
+    return (mnk_free_mask(rules, board) >> cell) & 1;
+}
+
+/**
+ * Marca a casa para o jogador (1 ou 2). A casa deve estar livre.
+ */
+static inline void mnk_play(mnk_board_t *board, int player, int cell) {
+    board->mask[player - 1] |= 1u << cell;
+}
+
+/**
+ * Dono da casa: 0 (livre), 1 ou 2.
+ */
+static inline int mnk_owner(const mnk_board_t *board, int cell) {
+    if ((board->mask[0] >> cell) & 1)
+        return 1;
+    if ((board->mask[1] >> cell) & 1)
+        return 2;
+    return 0;
+}
+
+/**
+ * Resultado da partida: 1 ou 2 (vencedor), -1 (empate) ou 0 (em andamento).
+ */
+int mnk_winner(const mnk_rules_t *rules, const mnk_board_t *board);
+
+/** Sorteia as chaves de Zobrist e limpa a tabela. */
+void mnk_engine_init(mnk_engine_t *engine);
+
+/** Esquece as posições guardadas; necessário ao trocar de regras. */
+void mnk_engine_clear(mnk_engine_t *engine);
+
+/**
+ * Escolhe a jogada do jogador (1 ou 2) dentro dos limites do nível. random
+ * decide o lance ao acaso do nível (por exemplo, rand()); clock pode ser
+ * NULL, e então só a profundidade e os nós limitam a busca. Retorna a casa,
+ * ou -1 se o tabuleiro estiver cheio.
+ */
+int mnk_search(mnk_engine_t *engine, const mnk_rules_t *rules, const mnk_board_t *board,
+               int player, const mnk_level_t *level, uint32_t random, mnk_clock_fn clock,
+               mnk_result_t *result);
+
+#endif
@@ -0,0 +1,41 @@
+#include "panel.h"
+
+uint16_t panel_width(const panel_layout_t *panel) {
+    return panel->rotation & 1 ? panel->height : panel->width;
+}
+
+uint16_t panel_height(const panel_layout_t *panel) {
+    return panel->rotation & 1 ? panel->width : panel->height;
+}
+
+uint32_t panel_index(const panel_layout_t *panel, uint16_t x, uint16_t y) {
+    // Coordenadas na matriz física, com a linha 0 em cima.
+    uint16_t col, row;
+    switch (panel->rotation) {
+    case PANEL_ROT_90:
+        col = (uint16_t)(panel->width - 1 - y);
+        row = x;
+        break;
+    case PANEL_ROT_180:
+        col = (uint16_t)(panel->width - 1 - x);
+        row = (uint16_t)(panel->height - 1 - y);
+        break;
+    case PANEL_ROT_270:
+        col = y;
+        row = (uint16_t)(panel->height - 1 - x);
+        break;
+    default:
+        col = x;
+        row = y;
+        break;
+    }
+    if (panel->bottom_first)
+        row = (uint16_t)(panel->height - 1 - row);
+
+    // Linha dentro da fita; a serpentina inverte as linhas ímpares de cada uma.
+    uint16_t rows = (uint16_t)(panel->height / panel->strips);
+    uint16_t strip = row / rows, strip_row = row % rows;
+    if (panel->order == PANEL_SERPENTINE && (strip_row & 1))
+        col = (uint16_t)(panel->width - 1 - col);
+    return strip * panel_strip_len(panel) + (uint32_t) strip_row * panel->width + col;
+}
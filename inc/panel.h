@@ -0,0 +1,47 @@
+#ifndef PANEL_H
+#define PANEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ---------------------- Layout de Matrizes de LEDs ----------------------
+// Descreve onde cada pixel de uma imagem (x para a direita, y para baixo, a
+// partir do canto superior esquerdo) fica nas fitas WS2812. A matriz física
+// tem width x height LEDs ligados linha a linha a partir do canto esquerdo
+// de cima ou de baixo; em serpentina, as linhas alternam de sentido. A
+// rotação gira a imagem sobre a matriz, o que também cobre os cantos da
+// direita e matrizes ligadas por colunas. Uma matriz grande pode ser
+// dividida em faixas de linhas iguais, uma por fita, enviadas em paralelo;
+// cada fita recomeça a serpentina na sua primeira linha. O índice é a
+// posição no quadro, com as fitas uma depois da outra. Não depende do
+// pico-sdk.
+
+enum { PANEL_ROW_MAJOR = 0, PANEL_SERPENTINE = 1 };
+
+// Rotação da imagem no sentido horário.
+enum { PANEL_ROT_0 = 0, PANEL_ROT_90, PANEL_ROT_180, PANEL_ROT_270 };
+
+typedef struct {
+    uint16_t width, height;         // LEDs da matriz física, na ordem das linhas
+    uint8_t order;                  // PANEL_ROW_MAJOR ou PANEL_SERPENTINE
+    uint8_t rotation;               // PANEL_ROT_*
+    bool bottom_first;              // A fita começa pela linha de baixo
+    uint8_t strips;                 // Fitas em paralelo; deve dividir height
+} panel_layout_t;
+
+/** Largura e altura da imagem, já com a rotação. */
+uint16_t panel_width(const panel_layout_t *panel);
+uint16_t panel_height(const panel_layout_t *panel);
+
+/** LEDs de cada fita. */
+static inline uint32_t panel_strip_len(const panel_layout_t *panel) {
+    return (uint32_t) panel->width * panel->height / panel->strips;
+}
+
+/**
+ * Posição no quadro do pixel (x, y) da imagem. As coordenadas devem estar
+ * dentro de panel_width() x panel_height().
+ */
+uint32_t panel_index(const panel_layout_t *panel, uint16_t x, uint16_t y);
+
+#endif
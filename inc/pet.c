@@ -0,0 +1,65 @@
+#include <stddef.h>
+
+#include "pet_store.h"
+
+// Um pet_t é uma população de um só: as contas ficam em pet_store.c, e
+// estas funções só montam a vista sobre os campos do pet_t. A leitura usa
+// pet_store_value_q8() direto nos campos, sem vista.
+
+static void pet_as_store(pet_t *pet, pet_store_t *store) {
+    uint16_t *stat_q8[PET_STATS];
+    for (int i = 0; i < PET_STATS; i++)
+        stat_q8[i] = &pet->base_q8[i];
+    pet_store_init(store, 1, stat_q8, &pet->rate_q8, NULL, pet->interval_ms);
+    store->anchor_ms = pet->anchor_ms;
+}
+
+/**
+ * Aplica os passos vencidos e avança a âncora, mantendo a fase.
+ */
+static void pet_settle(pet_t *pet, pet_store_t *store, uint64_t now_ms) {
+    pet_as_store(pet, store);
+    uint32_t steps = pet_store_steps(store, now_ms);
+    pet_store_decay(store, 0, 1, steps);
+    pet_store_commit(store, steps, now_ms);
+    pet->anchor_ms = store->anchor_ms;
+}
+
+void pet_init(pet_t *pet, const uint16_t values_q8[PET_STATS], uint32_t interval_ms) {
+    for (int i = 0; i < PET_STATS; i++)
+        pet->base_q8[i] = values_q8[i] > PET_MAX_Q8 ? PET_MAX_Q8 : values_q8[i];
+    pet->anchor_ms = 0;
+    pet->interval_ms = interval_ms;
+    pet->rate_q8 = 0;
+}
+
+void pet_start(pet_t *pet, uint16_t rate_q8, uint64_t now_ms) {
+    pet_store_t store;
+    pet_settle(pet, &store, now_ms);
+    pet->rate_q8 = rate_q8;
+    pet->anchor_ms = now_ms;
+}
+
+uint16_t pet_get_q8(const pet_t *pet, pet_stat_t stat, uint64_t now_ms) {
+    return pet_store_value_q8(pet->base_q8[stat], pet->rate_q8, pet->anchor_ms,
+                              pet->interval_ms, now_ms);
+}
+
+void pet_add(pet_t *pet, pet_stat_t stat, int delta, uint64_t now_ms) {
+    pet_store_t store;
+    pet_settle(pet, &store, now_ms);
+    pet_store_add(&store, 0, stat, delta);
+}
+
+uint32_t pet_next_step_ms(const pet_t *pet, uint64_t now_ms) {
+    if (now_ms <= pet->anchor_ms)
+        return pet->interval_ms;
+    return pet->interval_ms - (uint32_t)((now_ms - pet->anchor_ms) % pet->interval_ms);
+}
+
+pet_mood_t pet_mood(const pet_t *pet, uint64_t now_ms) {
+    uint16_t q8[PET_STATS];
+    for (int i = 0; i < PET_STATS; i++)
+        q8[i] = pet_get_q8(pet, (pet_stat_t) i, now_ms);
+    return pet_mood_q8(q8);
+}
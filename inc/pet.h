@@ -0,0 +1,101 @@
+#ifndef PET_H
+#define PET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ---------------------- Atributos do Pet ----------------------
+// Os atributos são guardados em ponto fixo Q8 junto com o início do passo
+// de decaimento atual. O valor num instante é calculado na leitura: a cada
+// interval_ms completo desde a âncora, cada atributo perde rate_q8. Nada
+// roda periodicamente, e um intervalo longo custa o mesmo que um curto.
+// As contas são as de pet_store.h, com o pet_t visto como uma população de
+// um só, então as duas formas não divergem. Não depende do pico-sdk, então
+// compila também no host.
+
+#define PET_Q           8
+#define PET_ONE         (1u << PET_Q)
+#define PET_MAX         100
+#define PET_MAX_Q8      (PET_MAX * PET_ONE)
+
+typedef enum {
+    PET_FOME = 0,
+    PET_HIGIENE,
+    PET_ENERGIA,
+    PET_DIVERSAO,
+    PET_STATS
+} pet_stat_t;
+
+// Humor: triste com qualquer atributo abaixo de PET_SAD_BELOW; feliz quando
+// a maioria está acima de PET_HAPPY_ABOVE.
+#define PET_SAD_BELOW   30
+#define PET_HAPPY_ABOVE 50
+
+typedef enum {
+    PET_SAD = 0,
+    PET_NEUTRAL,
+    PET_HAPPY
+} pet_mood_t;
+
+typedef struct {
+    uint16_t base_q8[PET_STATS];    // Valores na âncora
+    uint64_t anchor_ms;             // Início do passo de decaimento atual
+    uint32_t interval_ms;           // Duração de um passo
+    uint16_t rate_q8;               // Queda por passo (0 = parado)
+} pet_t;
+
+/**
+ * Define os valores (Q8) e para o decaimento.
+ */
+void pet_init(pet_t *pet, const uint16_t values_q8[PET_STATS], uint32_t interval_ms);
+
+/**
+ * Inicia o decaimento a partir de agora, com a queda por passo em Q8
+ * (por exemplo, 4,0 pontos = 1024).
+ */
+void pet_start(pet_t *pet, uint16_t rate_q8, uint64_t now_ms);
+
+uint16_t pet_get_q8(const pet_t *pet, pet_stat_t stat, uint64_t now_ms);
+
+/**
+ * Valor inteiro (0-100) exibido ao jogador.
+ */
+static inline int pet_get(const pet_t *pet, pet_stat_t stat, uint64_t now_ms) {
+    return pet_get_q8(pet, stat, now_ms) >> PET_Q;
+}
+
+/**
+ * Soma delta pontos (positivo ou negativo) com saturação em 0 e 100. Os
+ * passos vencidos são aplicados antes, sem mudar a fase do decaimento.
+ */
+void pet_add(pet_t *pet, pet_stat_t stat, int delta, uint64_t now_ms);
+
+/**
+ * Tempo até o próximo passo de decaimento.
+ */
+uint32_t pet_next_step_ms(const pet_t *pet, uint64_t now_ms);
+
+/**
+ * Valor depois de uma queda, saturado em 0. Regra comum ao pet_t e ao
+ * pet_store_t.
+ */
+static inline uint16_t pet_decayed(uint16_t base_q8, uint32_t drop_q8) {
+    return drop_q8 >= base_q8 ? 0 : (uint16_t)(base_q8 - drop_q8);
+}
+
+/**
+ * Humor a partir dos atributos em Q8, sem desvios; a versão em lote de
+ * pet_store_t faz a mesma conta.
+ */
+static inline pet_mood_t pet_mood_q8(const uint16_t q8[PET_STATS]) {
+    int sad = 0, above = 0;
+    for (int i = 0; i < PET_STATS; i++) {
+        sad |= q8[i] < PET_SAD_BELOW * PET_ONE;
+        above += q8[i] >= (PET_HAPPY_ABOVE + 1) * PET_ONE;
+    }
+    return sad ? PET_SAD : above > PET_STATS - above ? PET_HAPPY : PET_NEUTRAL;
+}
+
+pet_mood_t pet_mood(const pet_t *pet, uint64_t now_ms);
+
+#endif
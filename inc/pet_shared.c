@@ -0,0 +1,57 @@
+#include <string.h>
+
+#include "pet_shared.h"
+
+void pet_shared_write_begin(pet_shared_t *shared) {
+    __atomic_store_n(&shared->seq, shared->seq + 1, __ATOMIC_RELAXED);
+    // A sequência ímpar fica visível antes de qualquer campo mudar.
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void pet_shared_write_end(pet_shared_t *shared) {
+    __atomic_store_n(&shared->seq, shared->seq + 1, __ATOMIC_RELEASE);
+}
+
+void pet_shared_init(pet_shared_t *shared, const uint16_t values_q8[PET_STATS],
+                     uint32_t interval_ms) {
+    shared->seq = 0;
+    pet_init(&shared->pet, values_q8, interval_ms);
+}
+
+void pet_shared_read(const pet_shared_t *shared, pet_t *out) {
+    uint32_t seq;
+    do {
+        seq = __atomic_load_n(&shared->seq, __ATOMIC_ACQUIRE);
+        memcpy(out, &shared->pet, sizeof(*out));
+        // A cópia termina antes de conferir a sequência de novo.
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || __atomic_load_n(&shared->seq, __ATOMIC_RELAXED) != seq);
+}
+
+void pet_shared_view(const pet_shared_t *shared, uint64_t now_ms, pet_view_t *view) {
+    pet_t pet;
+    pet_shared_read(shared, &pet);
+    for (int i = 0; i < PET_STATS; i++)
+        view->q8[i] = pet_get_q8(&pet, (pet_stat_t) i, now_ms);
+    view->next_step_ms = pet_next_step_ms(&pet, now_ms);
+}
+
+void pet_shared_reset(pet_shared_t *shared, const uint16_t values_q8[PET_STATS]) {
+    pet_shared_write_begin(shared);
+    pet_init(&shared->pet, values_q8, shared->pet.interval_ms);
+    pet_shared_write_end(shared);
+}
+
+void pet_shared_start(pet_shared_t *shared, uint16_t rate_q8, uint64_t now_ms) {
+    pet_shared_write_begin(shared);
+    pet_start(&shared->pet, rate_q8, now_ms);
+    pet_shared_write_end(shared);
+}
+
+void pet_shared_apply(pet_shared_t *shared, const int8_t delta[PET_STATS], uint64_t now_ms) {
+    pet_shared_write_begin(shared);
+    for (int i = 0; i < PET_STATS; i++)
+        if (delta[i] != 0)
+            pet_add(&shared->pet, (pet_stat_t) i, delta[i], now_ms);
+    pet_shared_write_end(shared);
+}
@@ -0,0 +1,70 @@
+#ifndef PET_SHARED_H
+#define PET_SHARED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pet.h"
+
+// ---------------------- Pet Compartilhado ----------------------
+// Um pet_t publicado por seqlock. Um único contexto, o dono, altera o
+// estado, marcando a sequência como ímpar durante a escrita; os leitores
+// copiam o estado e repetem a cópia se a sequência mudou no meio, então
+// nunca veem metade de uma atualização e ninguém desliga interrupções.
+// Quem não é o dono só lê: no firmware, o laço principal aplica toda
+// mudança (ações, jogos, comandos da USB) e o núcleo 1 e as interrupções
+// apenas leem. Um leitor não pode interromper o dono no mesmo núcleo, pois
+// esperaria por uma escrita que não termina. Não depende do pico-sdk.
+
+typedef struct {
+    uint32_t seq;                   // Ímpar durante uma escrita
+    pet_t pet;
+} pet_shared_t;
+
+/** Retrato consistente dos atributos num instante. */
+typedef struct {
+    uint16_t q8[PET_STATS];
+    uint32_t next_step_ms;
+} pet_view_t;
+
+/** Inicia como pet_init(). Antes de qualquer leitor. */
+void pet_shared_init(pet_shared_t *shared, const uint16_t values_q8[PET_STATS],
+                     uint32_t interval_ms);
+
+// ---------------------- Leitores ----------------------
+
+/** Cópia do estado, sem mistura de escritas diferentes. */
+void pet_shared_read(const pet_shared_t *shared, pet_t *out);
+
+void pet_shared_view(const pet_shared_t *shared, uint64_t now_ms, pet_view_t *view);
+
+static inline int pet_view_get(const pet_view_t *view, pet_stat_t stat) {
+    return view->q8[stat] >> PET_Q;
+}
+
+static inline pet_mood_t pet_view_mood(const pet_view_t *view) {
+    return pet_mood_q8(view->q8);
+}
+
+// ---------------------- Dono ----------------------
+
+/**
+ * Cercam uma alteração direta de shared->pet pelas funções de pet.h; as
+ * funções abaixo já fazem isso.
+ */
+void pet_shared_write_begin(pet_shared_t *shared);
+void pet_shared_write_end(pet_shared_t *shared);
+
+/** pet_init() sobre o estado publicado. */
+void pet_shared_reset(pet_shared_t *shared, const uint16_t values_q8[PET_STATS]);
+
+/** pet_start() sobre o estado publicado. */
+void pet_shared_start(pet_shared_t *shared, uint16_t rate_q8, uint64_t now_ms);
+
+/**
+ * Soma um vetor de variações numa única escrita, cada uma saturada em
+ * 0..100 como em pet_add().
+ */
+void pet_shared_apply(pet_shared_t *shared, const int8_t delta[PET_STATS], uint64_t now_ms);
+
+#endif
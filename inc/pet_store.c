@@ -0,0 +1,82 @@
+#include "pet_store.h"
+
+void pet_store_init(pet_store_t *store, uint32_t count, uint16_t *stat_q8[PET_STATS],
+                    uint16_t *rate_q8, uint8_t *mood, uint32_t interval_ms) {
+    store->count = count;
+    for (int i = 0; i < PET_STATS; i++)
+        store->stat_q8[i] = stat_q8[i];
+    store->rate_q8 = rate_q8;
+    store->mood = mood;
+    store->anchor_ms = 0;
+    store->interval_ms = interval_ms;
+}
+
+// Passos completos de interval_ms entre anchor_ms e now_ms.
+static uint32_t pet_store_steps_since(uint64_t anchor_ms, uint32_t interval_ms, uint64_t now_ms) {
+    if (now_ms <= anchor_ms)
+        return 0;
+    uint64_t steps = (now_ms - anchor_ms) / interval_ms;
+    // Passos além deste já zeram qualquer atributo.
+    return steps > PET_MAX_Q8 ? PET_MAX_Q8 : (uint32_t) steps;
+}
+
+uint32_t pet_store_steps(const pet_store_t *store, uint64_t now_ms) {
+    return pet_store_steps_since(store->anchor_ms, store->interval_ms, now_ms);
+}
+
+// Queda de steps passos, limitada a 100 pontos.
+static inline uint32_t pet_store_drop(uint32_t steps, uint16_t rate_q8) {
+    uint32_t drop = steps * rate_q8;
+    return drop > PET_MAX_Q8 ? PET_MAX_Q8 : drop;
+}
+
+void pet_store_decay(pet_store_t *store, uint32_t first, uint32_t count, uint32_t steps) {
+    if (steps == 0)
+        return;
+    const uint16_t *restrict rate = store->rate_q8 + first;
+    for (int s = 0; s < PET_STATS; s++) {
+        uint16_t *restrict stat = store->stat_q8[s] + first;
+        for (uint32_t i = 0; i < count; i++)
+            stat[i] = pet_decayed(stat[i], pet_store_drop(steps, rate[i]));
+    }
+}
+
+void pet_store_commit(pet_store_t *store, uint32_t steps, uint64_t now_ms) {
+    store->anchor_ms += (uint64_t) steps * store->interval_ms;
+    // Depois de zerar tudo, a fase só precisa ficar a menos de um passo.
+    if (now_ms > store->anchor_ms && now_ms - store->anchor_ms >= store->interval_ms)
+        store->anchor_ms = now_ms - (now_ms - store->anchor_ms) % store->interval_ms;
+}
+
+void pet_store_classify(pet_store_t *store, uint32_t first, uint32_t count) {
+    const uint16_t *restrict fome = store->stat_q8[PET_FOME] + first;
+    const uint16_t *restrict higiene = store->stat_q8[PET_HIGIENE] + first;
+    const uint16_t *restrict energia = store->stat_q8[PET_ENERGIA] + first;
+    const uint16_t *restrict diversao = store->stat_q8[PET_DIVERSAO] + first;
+    uint8_t *restrict mood = store->mood + first;
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t q8[PET_STATS] = {fome[i], higiene[i], energia[i], diversao[i]};
+        mood[i] = (uint8_t) pet_mood_q8(q8);
+    }
+}
+
+void pet_store_add(pet_store_t *store, uint32_t index, pet_stat_t stat, int delta) {
+    int32_t value = (int32_t) store->stat_q8[stat][index] + delta * (int32_t) PET_ONE;
+    if (value < 0)
+        value = 0;
+    else if (value > (int32_t) PET_MAX_Q8)
+        value = PET_MAX_Q8;
+    store->stat_q8[stat][index] = (uint16_t) value;
+}
+
+uint16_t pet_store_get_q8(const pet_store_t *store, uint32_t index, pet_stat_t stat,
+                          uint64_t now_ms) {
+    return pet_store_value_q8(store->stat_q8[stat][index], store->rate_q8[index],
+                              store->anchor_ms, store->interval_ms, now_ms);
+}
+
+uint16_t pet_store_value_q8(uint16_t base_q8, uint16_t rate_q8, uint64_t anchor_ms,
+                            uint32_t interval_ms, uint64_t now_ms) {
+    uint32_t steps = pet_store_steps_since(anchor_ms, interval_ms, now_ms);
+    return pet_decayed(base_q8, pet_store_drop(steps, rate_q8));
+}
@@ -0,0 +1,62 @@
+#ifndef PET_STORE_H
+#define PET_STORE_H
+
+#include <stdint.h>
+
+#include "pet.h"
+
+// ---------------------- População de Pets ----------------------
+// As mesmas regras de pet.h para muitos pets, guardadas como estrutura de
+// vetores: um vetor contíguo de Q8 por atributo, a queda por passo de cada
+// pet e o humor calculado. Todos os pets compartilham o relógio de
+// decaimento, então o número de passos é calculado uma vez e os laços de
+// queda e humor não têm desvios nem divisões, o que deixa o compilador
+// vetorizá-los. Os vetores são do chamador, e as funções de lote recebem
+// uma faixa [first, first + count) para dividir a população entre threads
+// que não compartilham memória. Não depende do pico-sdk.
+
+typedef struct {
+    uint32_t count;
+    uint16_t *stat_q8[PET_STATS];   // Um vetor por atributo
+    uint16_t *rate_q8;              // Queda por passo de cada pet
+    uint8_t *mood;                  // pet_mood_t, atualizado por pet_store_classify()
+    uint64_t anchor_ms;             // Início do passo atual, comum a todos
+    uint32_t interval_ms;
+} pet_store_t;
+
+/**
+ * Associa os vetores do chamador (count posições cada) e zera o relógio.
+ * Os valores ficam como estão.
+ */
+void pet_store_init(pet_store_t *store, uint32_t count, uint16_t *stat_q8[PET_STATS],
+                    uint16_t *rate_q8, uint8_t *mood, uint32_t interval_ms);
+
+/**
+ * Passos vencidos desde a âncora. Um lote é pet_store_steps(), a queda de
+ * todas as faixas e pet_store_commit() com o mesmo número de passos.
+ */
+uint32_t pet_store_steps(const pet_store_t *store, uint64_t now_ms);
+
+void pet_store_decay(pet_store_t *store, uint32_t first, uint32_t count, uint32_t steps);
+
+/** Avança a âncora pelos passos já aplicados a todos os pets. */
+void pet_store_commit(pet_store_t *store, uint32_t steps, uint64_t now_ms);
+
+/** Recalcula o humor da faixa, com a regra de pet_mood_q8(). */
+void pet_store_classify(pet_store_t *store, uint32_t first, uint32_t count);
+
+/** Soma delta pontos a um atributo de um pet, com saturação em 0 e 100. */
+void pet_store_add(pet_store_t *store, uint32_t index, pet_stat_t stat, int delta);
+
+/** Valor de um atributo de um pet em now_ms, sem aplicar os passos. */
+uint16_t pet_store_get_q8(const pet_store_t *store, uint32_t index, pet_stat_t stat,
+                          uint64_t now_ms);
+
+/**
+ * A conta de pet_store_get_q8() sobre valores soltos: o atributo na âncora,
+ * a queda por passo e o relógio. Serve a quem só pode ler, como o pet_t.
+ */
+uint16_t pet_store_value_q8(uint16_t base_q8, uint16_t rate_q8, uint64_t anchor_ms,
+                            uint32_t interval_ms, uint64_t now_ms);
+
+#endif
@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "prof.h"
+
+void prof_record(prof_section_t *section, uint32_t elapsed_us) {
+    // Faixa i: [2^i, 2^(i+1)), com 0 e 1 na primeira.
+    uint32_t bucket = 31 - (uint32_t) __builtin_clz(elapsed_us | 1);
+    if (bucket >= PROF_BUCKETS)
+        bucket = PROF_BUCKETS - 1;
+    section->hist[bucket]++;
+    section->count++;
+    section->total_us += elapsed_us;
+    if (elapsed_us < section->min_us)
+        section->min_us = elapsed_us;
+    if (elapsed_us > section->max_us)
+        section->max_us = elapsed_us;
+}
+
+void prof_reset(prof_section_t *section) {
+    const char *name = section->name;
+    memset(section, 0, sizeof(*section));
+    section->name = name;
+    section->min_us = UINT32_MAX;
+}
+
+void prof_print(const prof_section_t *sections, int count) {
+    printf("Perfil (us): trecho n min media max | histograma\n");
+    for (int i = 0; i < count; i++) {
+        const prof_section_t *s = &sections[i];
+        if (s->count == 0) {
+            printf("  %-10s 0\n", s->name);
+            continue;
+        }
+        printf("  %-10s %lu %lu %lu %lu |", s->name, (unsigned long) s->count,
+               (unsigned long) s->min_us, (unsigned long)(s->total_us / s->count),
+               (unsigned long) s->max_us);
+        for (int b = 0; b < PROF_BUCKETS; b++) {
+            if (s->hist[b] == 0)
+                continue;
+            if (b == PROF_BUCKETS - 1)
+                printf(" >=%lu:%lu", 1ul << b, (unsigned long) s->hist[b]);
+            else
+                printf(" <%lu:%lu", 2ul << b, (unsigned long) s->hist[b]);
+        }
+        printf("\n");
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef PROF_H
+#define PROF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ---------------------- Perfil dos Trechos Quentes ----------------------
+// Cada trecho medido acumula contagem, mínimo, máximo, soma e um histograma
+// em potências de 2, em microssegundos do timer do RP2040 (time_us_32, que
+// tem de estar declarado onde as macros são usadas). Não são ciclos: o M0+
+// não tem o contador DWT, e o SysTick (24 bits, um por núcleo) dá a volta
+// em 134 ms a 125 MHz, muda de ritmo com o clk_sys do modo ocioso e não
+// mede a latência, que começa num núcleo e termina no outro. O timer vale
+// para os dois núcleos e todos os clocks, mas com passo de 1 us: mínimo,
+// máximo e histograma erram em até 1 us, e trechos mais curtos caem na
+// primeira faixa. A média continua fiel, pois o início cai em qualquer fase
+// do microssegundo. Um trecho deve ser gravado por um único núcleo; quem
+// imprime pode ler um registro pela metade, o que basta para um relatório.
+// Com PROF_ENABLED em 0 as macros não geram código.
+
+#ifndef PROF_ENABLED
+#define PROF_ENABLED    1
+#endif
+
+#define PROF_BUCKETS    16          // [0,2) [2,4) ... [32768,∞) us
+
+typedef struct {
+    const char *name;
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t hist[PROF_BUCKETS];
+} prof_section_t;
+
+#define PROF_SECTION(label) {.name = (label), .min_us = UINT32_MAX}
+
+void prof_record(prof_section_t *section, uint32_t elapsed_us);
+
+void prof_reset(prof_section_t *section);
+
+/**
+ * Imprime uma linha por trecho (printf): contagem, mínimo, média, máximo e
+ * as faixas não vazias do histograma, pelo limite superior.
+ */
+void prof_print(const prof_section_t *sections, int count);
+
+#if PROF_ENABLED
+#define PROF_BEGIN(t)               uint32_t t = time_us_32()
+#define PROF_END(section, t)        prof_record((section), time_us_32() - (t))
+#else
+#define PROF_BEGIN(t)
+#define PROF_END(section, t)        ((void) 0)
+#endif
+
+#endif
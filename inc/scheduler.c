@@ -0,0 +1,99 @@
+#include "scheduler.h"
+#include "pico/stdlib.h"
+
+// Lista simplesmente encadeada, ordenada por prazo crescente.
+static sched_task_t *sched_head = NULL;
+static sched_stats_t sched_stats;
+
+static void sched_unlink(sched_task_t *task) {
+    sched_task_t **link = &sched_head;
+    while (*link != NULL) {
+        if (*link == task) {
+            *link = task->next;
+            break;
+        }
+        link = &(*link)->next;
+    }
+    task->next = NULL;
+    task->active = false;
+}
+
+static void sched_insert(sched_task_t *task) {
+    // Prazos iguais mantêm a ordem de inserção.
+    sched_task_t **link = &sched_head;
+    while (*link != NULL && (*link)->deadline_us <= task->deadline_us)
+        link = &(*link)->next;
+    task->next = *link;
+    *link = task;
+    task->active = true;
+}
+
+static void sched_add_at(sched_task_t *task, uint64_t deadline_us, uint32_t period_us,
+                         sched_fn_t fn, void *arg) {
+    if (task->active)
+        sched_unlink(task);
+    task->fn = fn;
+    task->arg = arg;
+    task->period_us = period_us;
+    task->deadline_us = deadline_us;
+    sched_insert(task);
+}
+
+static void sched_add(sched_task_t *task, uint64_t delay_us, uint32_t period_us,
+                      sched_fn_t fn, void *arg) {
+    sched_add_at(task, time_us_64() + delay_us, period_us, fn, arg);
+}
+
+void sched_every_ms(sched_task_t *task, uint32_t period_ms, sched_fn_t fn, void *arg) {
+    sched_add(task, (uint64_t)period_ms * 1000, period_ms * 1000, fn, arg);
+}
+
+void sched_after_ms(sched_task_t *task, uint32_t delay_ms, sched_fn_t fn, void *arg) {
+    sched_add(task, (uint64_t)delay_ms * 1000, 0, fn, arg);
+}
+
+void sched_at_us(sched_task_t *task, uint64_t deadline_us, sched_fn_t fn, void *arg) {
+    sched_add_at(task, deadline_us, 0, fn, arg);
+}
+
+void sched_cancel(sched_task_t *task) {
+    if (task->active)
+        sched_unlink(task);
+}
+
+bool sched_pending(const sched_task_t *task) {
+    return task->active;
+}
+
+void sched_run(void) {
+    uint64_t now = time_us_64();
+    while (sched_head != NULL && sched_head->deadline_us <= now) {
+        sched_task_t *task = sched_head;
+        sched_head = task->next;
+        task->next = NULL;
+        task->active = false;
+        if (task->period_us != 0) {
+            // Mantém a cadência; se houve atraso maior que um período, realinha.
+            task->deadline_us += task->period_us;
+            if (task->deadline_us <= now)
+                task->deadline_us = now + task->period_us;
+            sched_insert(task);
+        }
+        task->fn(task->arg);
+    }
+}
+
+void sched_wait(void) {
+    uint64_t start = time_us_64();
+    if (sched_head == NULL)
+        __wfe();
+    else
+        best_effort_wfe_or_timeout(from_us_since_boot(sched_head->deadline_us));
+    // Inclui as interrupções atendidas ao acordar, que são curtas.
+    sched_stats.sleep_us += time_us_64() - start;
+    sched_stats.wakeups++;
+}
+
+sched_stats_t sched_get_stats(void) {
+    return sched_stats;
+}
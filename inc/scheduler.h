@@ -0,0 +1,61 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ---------------------- Escalonador Cooperativo ----------------------
+// Tarefas rodam até o fim no laço principal, em ordem de prazo. As estruturas
+// são alocadas pelo chamador (normalmente estáticas), sem memória dinâmica.
+
+typedef void (*sched_fn_t)(void *arg);
+
+typedef struct sched_task {
+    sched_fn_t fn;
+    void *arg;
+    uint64_t deadline_us;
+    uint32_t period_us;             // 0 = disparo único
+    bool active;
+    struct sched_task *next;
+} sched_task_t;
+
+/**
+ * Agenda uma tarefa periódica; a primeira execução ocorre após um período.
+ */
+void sched_every_ms(sched_task_t *task, uint32_t period_ms, sched_fn_t fn, void *arg);
+
+/**
+ * Agenda um evento de disparo único. Reagendar uma tarefa ativa substitui o prazo.
+ */
+void sched_after_ms(sched_task_t *task, uint32_t delay_ms, sched_fn_t fn, void *arg);
+
+/**
+ * Agenda um disparo único num instante absoluto de time_us_64(), sem acumular
+ * atrasos numa sequência de eventos.
+ */
+void sched_at_us(sched_task_t *task, uint64_t deadline_us, sched_fn_t fn, void *arg);
+
+void sched_cancel(sched_task_t *task);
+bool sched_pending(const sched_task_t *task);
+
+/**
+ * Executa todas as tarefas vencidas até o instante da chamada.
+ */
+void sched_run(void);
+
+/**
+ * Dorme até o próximo prazo ou até uma interrupção acordar o núcleo.
+ */
+void sched_wait(void);
+
+typedef struct {
+    uint64_t sleep_us;              // Tempo total dentro de sched_wait
+    uint32_t wakeups;               // Retornos de sched_wait
+} sched_stats_t;
+
+/**
+ * Contadores acumulados desde o boot, para medir o ciclo de trabalho.
+ */
+sched_stats_t sched_get_stats(void);
+
+#endif
@@ -0,0 +1,196 @@
+#include "ssd1306_dma.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+// Prazo de uma transferência: 20 bits por byte, o dobro de um byte com ACK
+// no barramento, mais uma folga fixa.
+#define SSD1306_DMA_TIMEOUT_BITS    20
+#define SSD1306_DMA_TIMEOUT_US      1000
+
+static i2c_inst_t *oled_i2c;
+static int oled_dma_channel;
+static uint oled_baudrate;
+
+static uint16_t cmd_buffers[2][SSD1306_DMA_BUFFER_WORDS];
+static uint fill_index = 0;             // Buffer recebendo novas regiões
+static uint fill_words = 0;
+static volatile bool in_flight = false;
+static volatile bool pending = false;   // Buffer de preenchimento aguardando o DMA
+static uint32_t deadline_us;            // Fim do prazo da transferência em andamento
+static volatile uint32_t abort_count = 0;
+
+static ssd1306_dma_callback_t done_callback = NULL;
+static void *done_arg = NULL;
+
+/**
+ * Conta e limpa um abort que chegou depois do fim do DMA, num dos bytes que
+ * ainda estavam no FIFO de TX. Chamada com o DMA parado.
+ */
+static void note_late_abort(void) {
+    i2c_hw_t *hw = i2c_get_hw(oled_i2c);
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        (void) hw->clr_tx_abrt;
+        abort_count++;
+    }
+}
+
+static bool controller_idle(void) {
+    uint32_t status = i2c_get_hw(oled_i2c)->status;
+    return (status & I2C_IC_STATUS_TFE_BITS) && !(status & I2C_IC_STATUS_ACTIVITY_BITS);
+}
+
+/**
+ * Dispara o buffer de preenchimento. Chamada com as interrupções desabilitadas.
+ */
+static void start_transfer(void) {
+    uint16_t *words = cmd_buffers[fill_index];
+    uint count = fill_words;
+    fill_index ^= 1;
+    fill_words = 0;
+    pending = false;
+    in_flight = true;
+    deadline_us = time_us_32() + SSD1306_DMA_TIMEOUT_US +
+                  count * (SSD1306_DMA_TIMEOUT_BITS * 1000000u / oled_baudrate);
+    // Um abort (NACK) anterior retém o FIFO de TX: é contado e limpo.
+    note_late_abort();
+    dma_channel_set_read_addr(oled_dma_channel, words, false);
+    dma_channel_set_trans_count(oled_dma_channel, count, true);
+}
+
+static void ssd1306_dma_irq_handler(void) {
+    if (!dma_channel_get_irq1_status(oled_dma_channel))
+        return;
+    dma_channel_acknowledge_irq1(oled_dma_channel);
+    in_flight = false;
+    if (pending)
+        start_transfer();
+    else if (done_callback != NULL)
+        done_callback(done_arg);
+}
+
+/**
+ * Cancela a transferência parada. Chamada com as interrupções desabilitadas.
+ */
+static void abort_transfer(void) {
+    // Com a interrupção do canal desligada, o abort não a dispara (errata
+    // RP2040-E13).
+    dma_channel_set_irq1_enabled(oled_dma_channel, false);
+    dma_channel_abort(oled_dma_channel);
+    dma_channel_acknowledge_irq1(oled_dma_channel);
+    dma_channel_set_irq1_enabled(oled_dma_channel, true);
+    (void) i2c_get_hw(oled_i2c)->clr_tx_abrt;
+    // As regiões pendentes continuariam um quadro incompleto.
+    fill_words = 0;
+    pending = false;
+    in_flight = false;
+    abort_count++;
+}
+
+void ssd1306_dma_init(i2c_inst_t *i2c, uint baudrate) {
+    oled_i2c = i2c;
+    oled_baudrate = i2c_set_baudrate(i2c, baudrate);
+
+    // O endereço de destino é fixo; cada STOP encerra uma transação e o
+    // próximo byte no FIFO gera um novo START.
+    i2c_hw_t *hw = i2c_get_hw(i2c);
+    hw->enable = 0;
+    hw->tar = ssd1306_i2c_address;
+    hw->enable = 1;
+
+    oled_dma_channel = dma_claim_unused_channel(true);
+    dma_channel_config cfg = dma_channel_get_default_config(oled_dma_channel);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, i2c_get_dreq(i2c, true));
+    dma_channel_configure(oled_dma_channel, &cfg, &hw->data_cmd, cmd_buffers[0], 0, false);
+
+    dma_channel_set_irq1_enabled(oled_dma_channel, true);
+    irq_add_shared_handler(DMA_IRQ_1, ssd1306_dma_irq_handler,
+                           PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+}
+
+bool ssd1306_dma_queue(const uint8_t *data, const struct render_area *area) {
+    uint length = (area->end_column - area->start_column + 1) *
+                  (area->end_page - area->start_page + 1);
+    // Controle de comandos + 6 bytes de endereçamento + controle de dados.
+    uint needed = 8 + length;
+
+    // O buffer de preenchimento pode ser disparado pela interrupção a
+    // qualquer momento, então a cópia é feita com ela desabilitada.
+    uint32_t irq_state = save_and_disable_interrupts();
+    if (fill_words + needed > SSD1306_DMA_BUFFER_WORDS) {
+        restore_interrupts(irq_state);
+        return false;
+    }
+    uint16_t *w = &cmd_buffers[fill_index][fill_words];
+    *w++ = 0x00;
+    *w++ = ssd1306_set_column_address;
+    *w++ = area->start_column;
+    *w++ = area->end_column;
+    *w++ = ssd1306_set_page_address;
+    *w++ = area->start_page;
+    *w++ = area->end_page | I2C_IC_DATA_CMD_STOP_BITS;
+    *w++ = 0x40;
+    for (uint i = 0; i < length; i++)
+        *w++ = data[i];
+    w[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+    fill_words += needed;
+    restore_interrupts(irq_state);
+    return true;
+}
+
+void ssd1306_dma_submit(void) {
+    uint32_t irq_state = save_and_disable_interrupts();
+    if (fill_words > 0) {
+        if (in_flight)
+            pending = true;
+        else
+            start_transfer();
+    }
+    restore_interrupts(irq_state);
+}
+
+bool ssd1306_dma_service(void) {
+    if (!in_flight) {
+        // Os últimos bytes saem do FIFO depois do fim do DMA, e um NACK
+        // neles só aparece com o controlador parado.
+        if (!controller_idle())
+            return true;
+        uint32_t irq_state = save_and_disable_interrupts();
+        if (!in_flight)
+            note_late_abort();
+        restore_interrupts(irq_state);
+        return false;
+    }
+    // Num abort, o controlador esvazia e retém o FIFO de TX, e o DMA fica
+    // parado sem gerar interrupção.
+    bool aborted = i2c_get_hw(oled_i2c)->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+    if (!aborted && (int32_t)(time_us_32() - deadline_us) < 0)
+        return true;
+    uint32_t irq_state = save_and_disable_interrupts();
+    if (in_flight)
+        abort_transfer();
+    restore_interrupts(irq_state);
+    return false;
+}
+
+uint32_t ssd1306_dma_aborts(void) {
+    return abort_count;
+}
+
+bool ssd1306_dma_busy(void) {
+    if (in_flight || pending)
+        return true;
+    // O DMA termina com até 16 bytes ainda no FIFO de TX do controlador.
+    if (!controller_idle())
+        return true;
+    note_late_abort();
+    return false;
+}
+
+void ssd1306_dma_set_callback(ssd1306_dma_callback_t callback, void *arg) {
+    done_callback = callback;
+    done_arg = arg;
+}
@@ -0,0 +1,63 @@
+#ifndef SSD1306_DMA_H
+#define SSD1306_DMA_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "ssd1306.h"
+
+// ---------------------- Transporte Assíncrono do SSD1306 ----------------------
+// As regiões são convertidas em palavras de IC_DATA_CMD (comandos de
+// endereçamento + dados, com STOP no último byte de cada transação) e
+// enviadas pelo DMA direto ao FIFO de TX do I2C. Enquanto um buffer está no
+// barramento, o outro acumula as regiões seguintes.
+
+// Capacidade de cada buffer: um quadro completo mais o endereçamento das páginas.
+#define SSD1306_DMA_BUFFER_WORDS  (ssd1306_buffer_length + 16 * ssd1306_n_pages)
+
+typedef void (*ssd1306_dma_callback_t)(void *arg);
+
+/**
+ * Reserva o canal de DMA e ajusta o barramento para baudrate (Hz). Deve ser
+ * chamada depois de ssd1306_init(), que usa escritas bloqueantes.
+ */
+void ssd1306_dma_init(i2c_inst_t *i2c, uint baudrate);
+
+/**
+ * Copia uma região para o buffer em preenchimento. Retorna false se não
+ * houver espaço; nesse caso nada é enfileirado.
+ */
+bool ssd1306_dma_queue(const uint8_t *data, const struct render_area *area);
+
+/**
+ * Envia as regiões acumuladas: dispara já se o DMA estiver livre, senão
+ * ficam pendentes até a conclusão da transferência atual.
+ */
+void ssd1306_dma_submit(void);
+
+/**
+ * Confere a transferência em andamento. Num abort do I2C (NACK, erro de
+ * barramento) ou passado o prazo, cancela o DMA e descarta as regiões
+ * pendentes; um abort nos bytes que ficaram no FIFO depois do DMA também é
+ * contado. Retorna true enquanto houver bytes a caminho do barramento; o
+ * abort não gera evento, então o chamador volta a conferir sem esperar um.
+ */
+bool ssd1306_dma_service(void);
+
+/**
+ * Transferências canceladas desde o início. Quando muda, o conteúdo do
+ * painel é incerto e deve ser reenviado por inteiro.
+ */
+uint32_t ssd1306_dma_aborts(void);
+
+/**
+ * Indica se há transferência em andamento ou pendente, ou bytes ainda no
+ * FIFO de TX do I2C.
+ */
+bool ssd1306_dma_busy(void);
+
+/**
+ * Define a função chamada (em contexto de interrupção) quando o DMA esvazia a fila.
+ */
+void ssd1306_dma_set_callback(ssd1306_dma_callback_t callback, void *arg);
+
+#endif
@@ -0,0 +1,292 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "store.h"
+#include "pico/stdlib.h"
+
+#define STORE_KEY_HEADER    0
+#define STORE_HEADER_LEN    5           // Geração (4 bytes) + registros copiados
+
+typedef struct {
+    uint32_t sector;
+    uint32_t generation;
+    bool complete;                  // Todas as cópias do cabeçalho conferem
+} sector_info_t;
+
+static uint32_t store_crc32(const uint8_t *data, uint32_t len) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+    }
+    return ~crc;
+}
+
+static const store_record_t *slot_at(const uint8_t *region, uint32_t sector, uint32_t slot) {
+    return (const store_record_t *) &region[sector * STORE_SECTOR_SIZE + slot * STORE_RECORD_SIZE];
+}
+
+static bool slot_free(const store_record_t *record) {
+    const uint8_t *bytes = (const uint8_t *) record;
+    for (uint32_t i = 0; i < STORE_RECORD_SIZE; i++)
+        if (bytes[i] != 0xFF)
+            return false;
+    return true;
+}
+
+static bool record_valid(const store_record_t *record) {
+    return record->key < STORE_MAX_KEYS && record->len <= STORE_DATA_MAX &&
+           record->crc == store_crc32((const uint8_t *) record, offsetof(store_record_t, crc));
+}
+
+static void record_make(store_record_t *record, uint8_t key, const void *data, uint32_t len) {
+    memset(record, 0, sizeof(*record));
+    record->key = key;
+    record->len = (uint8_t) len;
+    if (len > 0)
+        memcpy(record->data, data, len);
+    record->crc = store_crc32((const uint8_t *) record, offsetof(store_record_t, crc));
+}
+
+static bool sector_blank(const uint8_t *region, uint32_t sector) {
+    for (uint32_t slot = 0; slot < STORE_SLOTS; slot++)
+        if (!slot_free(slot_at(region, sector, slot)))
+            return false;
+    return true;
+}
+
+/**
+ * Lista os setores com cabeçalho válido em ordem crescente de geração.
+ */
+static uint32_t sector_list(const uint8_t *region, uint32_t sectors, sector_info_t *list) {
+    uint32_t count = 0;
+    for (uint32_t s = 0; s < sectors; s++) {
+        const store_record_t *header = slot_at(region, s, 0);
+        if (!record_valid(header) || header->key != STORE_KEY_HEADER ||
+            header->len != STORE_HEADER_LEN)
+            continue;
+        sector_info_t info = {.sector = s, .complete = true};
+        memcpy(&info.generation, header->data, sizeof(info.generation));
+        for (uint32_t slot = 1; slot <= header->data[4] && slot < STORE_SLOTS; slot++)
+            info.complete &= record_valid(slot_at(region, s, slot));
+
+        uint32_t i = count++;
+        while (i > 0 && list[i - 1].generation > info.generation) {
+            list[i] = list[i - 1];
+            i--;
+        }
+        list[i] = info;
+    }
+    return count;
+}
+
+uint32_t store_decode(const uint8_t *region, uint32_t sectors, store_visit_fn visit, void *ctx) {
+    sector_info_t list[32];
+    uint32_t count = sector_list(region, sectors, list);
+
+    // Setores anteriores ao último cabeçalho completo estão obsoletos.
+    uint32_t first = 0;
+    for (uint32_t i = 0; i < count; i++)
+        if (list[i].complete)
+            first = i;
+
+    uint32_t bad = 0;
+    for (uint32_t i = first; i < count; i++) {
+        for (uint32_t slot = 1; slot < STORE_SLOTS; slot++) {
+            const store_record_t *record = slot_at(region, list[i].sector, slot);
+            if (slot_free(record))
+                continue;
+            if (!record_valid(record) || record->key == STORE_KEY_HEADER) {
+                bad++;
+                continue;
+            }
+            visit(record, list[i].sector, list[i].generation, ctx);
+        }
+    }
+    return bad;
+}
+
+static void mount_visit(const store_record_t *record, uint32_t sector, uint32_t generation,
+                        void *ctx) {
+    store_t *store = ctx;
+    uint32_t offset = (uint32_t)((const uint8_t *) record - store->flash->base);
+    store->latest[record->key] = record->len > 0 ? offset + 1 : 0;
+}
+
+void store_mount(store_t *store, const store_flash_t *flash) {
+    memset(store, 0, sizeof(*store));
+    store->flash = flash;
+    store->sector = STORE_NO_SECTOR;
+
+    const uint8_t *region = flash->base;
+    for (uint32_t s = 0; s < flash->sectors; s++)
+        if (sector_blank(region, s))
+            store->erased_mask |= 1u << s;
+
+    sector_info_t list[32];
+    uint32_t count = sector_list(region, flash->sectors, list);
+    store->stats.bad_records = store_decode(region, flash->sectors, mount_visit, store);
+    if (count == 0)
+        return;
+
+    const sector_info_t *current = &list[count - 1];
+    store->sector = current->sector;
+    store->generation = current->generation;
+    store->compact_pending = !current->complete;
+    store->next_slot = 1;
+    for (uint32_t slot = 1; slot < STORE_SLOTS; slot++)
+        if (!slot_free(slot_at(region, current->sector, slot)))
+            store->next_slot = slot + 1;
+}
+
+int store_read(const store_t *store, uint8_t key, void *data, uint32_t max_len) {
+    if (key == STORE_KEY_HEADER || key >= STORE_MAX_KEYS || store->latest[key] == 0)
+        return -1;
+    const store_record_t *record =
+        (const store_record_t *) &store->flash->base[store->latest[key] - 1];
+    uint32_t len = record->len < max_len ? record->len : max_len;
+    memcpy(data, record->data, len);
+    return record->len;
+}
+
+static bool sector_holds_live(const store_t *store, uint32_t sector) {
+    for (uint32_t key = 1; key < STORE_MAX_KEYS; key++)
+        if (store->latest[key] != 0 && (store->latest[key] - 1) / STORE_SECTOR_SIZE == sector)
+            return true;
+    return false;
+}
+
+/**
+ * Programa count registros consecutivos, todos dentro de uma mesma página,
+ * e confere o resultado.
+ */
+static bool store_program(store_t *store, uint32_t offset, const store_record_t *records,
+                          uint32_t count) {
+    uint8_t page[STORE_PAGE_SIZE];
+    uint32_t page_offset = offset & ~(STORE_PAGE_SIZE - 1);
+    // Bytes 0xFF não alteram a flash: só as posições novas são gravadas.
+    memset(page, 0xFF, sizeof(page));
+    memcpy(&page[offset - page_offset], records, count * STORE_RECORD_SIZE);
+    store->flash->program(page_offset, page);
+    store->stats.writes++;
+    if (memcmp(&store->flash->base[offset], records, count * STORE_RECORD_SIZE) != 0) {
+        store->stats.errors++;
+        return false;
+    }
+    return true;
+}
+
+static void store_erase(store_t *store, uint32_t sector) {
+    store->flash->erase(sector * STORE_SECTOR_SIZE);
+    store->erased_mask |= 1u << sector;
+    store->stats.erases++;
+}
+
+/**
+ * Abre um novo setor: uma única página com o cabeçalho, a cópia mais recente
+ * de cada chave e o registro novo (se houver). Prefere setores já apagados.
+ */
+static bool store_rollover(store_t *store, const store_record_t *extra) {
+    uint32_t sectors = store->flash->sectors;
+    uint32_t target = STORE_NO_SECTOR;
+    for (int pass = 0; pass < 2 && target == STORE_NO_SECTOR; pass++) {
+        for (uint32_t i = 1; i <= sectors; i++) {
+            uint32_t s = (store->sector == STORE_NO_SECTOR ? i - 1 : store->sector + i) % sectors;
+            if (s == store->sector || sector_holds_live(store, s))
+                continue;
+            if (pass == 0 && !(store->erased_mask & (1u << s)))
+                continue;
+            target = s;
+            break;
+        }
+    }
+    if (target == STORE_NO_SECTOR)
+        return false;
+    if (!(store->erased_mask & (1u << target)))
+        store_erase(store, target);
+
+    store_record_t records[STORE_MAX_KEYS + 1];
+    uint8_t keys[STORE_MAX_KEYS + 1];
+    uint32_t count = 1;
+    for (uint32_t key = 1; key < STORE_MAX_KEYS; key++) {
+        if (store->latest[key] == 0 || (extra != NULL && extra->key == key))
+            continue;
+        memcpy(&records[count], &store->flash->base[store->latest[key] - 1], STORE_RECORD_SIZE);
+        keys[count++] = (uint8_t) key;
+    }
+    // Uma remoção só precisa deixar a chave de fora das cópias.
+    if (extra != NULL && extra->len > 0) {
+        records[count] = *extra;
+        keys[count++] = extra->key;
+    }
+
+    uint8_t header[STORE_HEADER_LEN];
+    uint32_t generation = store->generation + 1;
+    memcpy(header, &generation, sizeof(generation));
+    header[4] = (uint8_t)(count - 1);
+    record_make(&records[0], STORE_KEY_HEADER, header, sizeof(header));
+
+    uint32_t base = target * STORE_SECTOR_SIZE;
+    store->erased_mask &= ~(1u << target);
+    if (!store_program(store, base, records, count))
+        return false;
+
+    memset(store->latest, 0, sizeof(store->latest));
+    for (uint32_t i = 1; i < count; i++)
+        store->latest[keys[i]] = base + i * STORE_RECORD_SIZE + 1;
+    store->sector = target;
+    store->generation = generation;
+    store->next_slot = count;
+    store->compact_pending = false;
+    store->stats.rollovers++;
+    return true;
+}
+
+bool store_write(store_t *store, uint8_t key, const void *data, uint32_t len) {
+    if (key == STORE_KEY_HEADER || key >= STORE_MAX_KEYS || len > STORE_DATA_MAX)
+        return false;
+    uint64_t start = time_us_64();
+    store_record_t record;
+    record_make(&record, key, data, len);
+
+    bool ok;
+    if (store->sector == STORE_NO_SECTOR || store->next_slot == STORE_SLOTS ||
+        store->compact_pending) {
+        ok = store_rollover(store, &record);
+    } else {
+        uint32_t offset = store->sector * STORE_SECTOR_SIZE + store->next_slot * STORE_RECORD_SIZE;
+        // A posição é consumida mesmo se a gravação falhar.
+        store->next_slot++;
+        ok = store_program(store, offset, &record, 1);
+        if (ok)
+            store->latest[key] = len > 0 ? offset + 1 : 0;
+    }
+
+    uint32_t elapsed = (uint32_t)(time_us_64() - start);
+    if (elapsed > store->stats.max_write_us)
+        store->stats.max_write_us = elapsed;
+    return ok;
+}
+
+bool store_remove(store_t *store, uint8_t key) {
+    if (key == STORE_KEY_HEADER || key >= STORE_MAX_KEYS || store->latest[key] == 0)
+        return true;
+    return store_write(store, key, NULL, 0);
+}
+
+bool store_service(store_t *store) {
+    if (store->compact_pending && store->sector != STORE_NO_SECTOR)
+        return store_rollover(store, NULL);
+
+    bool erased = false;
+    for (uint32_t s = 0; s < store->flash->sectors; s++) {
+        if (s == store->sector || (store->erased_mask & (1u << s)) || sector_holds_live(store, s))
+            continue;
+        if (erased)
+            return true;
+        store_erase(store, s);
+        erased = true;
+    }
+    return false;
+}
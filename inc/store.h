@@ -0,0 +1,97 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ---------------------- Armazenamento em Flash ----------------------
+// Log de registros de 16 bytes numa região reservada de setores. Cada
+// gravação programa uma única página; quando o setor atual enche, a primeira
+// página de outro setor recebe um cabeçalho com as cópias mais recentes de
+// todas as chaves, e os setores antigos só são apagados depois, por
+// store_service(). O acesso à flash passa por um store_flash_t, então a
+// decodificação também roda no PC sobre um arquivo.
+
+#define STORE_SECTOR_SIZE   4096
+#define STORE_PAGE_SIZE     256
+#define STORE_RECORD_SIZE   16
+#define STORE_SLOTS         (STORE_SECTOR_SIZE / STORE_RECORD_SIZE)
+#define STORE_SECTORS       4           // Região padrão no fim da flash
+#define STORE_DATA_MAX      10          // Bytes de dados por registro
+#define STORE_MAX_KEYS      8           // Chaves 1..7; a 0 é o cabeçalho
+
+typedef struct {
+    uint8_t key;                    // 0xFF = posição livre
+    uint8_t len;                    // 0 = chave removida
+    uint8_t data[STORE_DATA_MAX];
+    uint32_t crc;                   // CRC-32 dos 12 bytes anteriores
+} store_record_t;
+
+/**
+ * Acesso à região. Os deslocamentos são relativos ao início da região;
+ * erase apaga um setor e program grava uma página alinhada.
+ */
+typedef struct {
+    const uint8_t *base;            // Leitura direta (XIP no Pico)
+    uint32_t sectors;               // No máximo 32
+    void (*erase)(uint32_t offset);
+    void (*program)(uint32_t offset, const uint8_t *page);
+} store_flash_t;
+
+typedef struct {
+    uint32_t writes;                // Páginas programadas
+    uint32_t erases;                // Setores apagados
+    uint32_t rollovers;             // Trocas de setor
+    uint32_t bad_records;           // Registros com CRC inválido na montagem
+    uint32_t errors;                // Páginas que não conferiram após gravar
+    uint32_t max_write_us;          // Pior latência de store_write
+} store_stats_t;
+
+typedef struct {
+    const store_flash_t *flash;
+    uint32_t generation;            // Geração do setor atual
+    uint32_t sector;                // Setor atual (STORE_NO_SECTOR se vazio)
+    uint32_t next_slot;             // Próxima posição livre do setor atual
+    uint32_t erased_mask;           // Setores apagados
+    uint32_t latest[STORE_MAX_KEYS];// Deslocamento + 1 do último registro (0 = ausente)
+    bool compact_pending;           // Cabeçalho do setor atual incompleto
+    store_stats_t stats;
+} store_t;
+
+#define STORE_NO_SECTOR     UINT32_MAX
+
+/**
+ * Percorre a região e reconstrói o índice das chaves. Registros cortados por
+ * queda de energia são ignorados.
+ */
+void store_mount(store_t *store, const store_flash_t *flash);
+
+/**
+ * Copia o valor atual da chave para data. Retorna o tamanho, ou -1 se a
+ * chave não existir.
+ */
+int store_read(const store_t *store, uint8_t key, void *data, uint32_t max_len);
+
+/**
+ * Acrescenta um registro. No pior caso apaga um setor e programa uma
+ * página; com store_service() em dia, só programa uma página.
+ */
+bool store_write(store_t *store, uint8_t key, const void *data, uint32_t len);
+
+bool store_remove(store_t *store, uint8_t key);
+
+/**
+ * Apaga um setor obsoleto, se houver. Retorna true se ainda restar trabalho.
+ */
+bool store_service(store_t *store);
+
+typedef void (*store_visit_fn)(const store_record_t *record, uint32_t sector,
+                               uint32_t generation, void *ctx);
+
+/**
+ * Visita os registros válidos de uma imagem da região, em ordem de gravação,
+ * sem depender de store_t. Retorna o número de registros inválidos.
+ */
+uint32_t store_decode(const uint8_t *region, uint32_t sectors, store_visit_fn visit, void *ctx);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ---------------------- Texto no OLED ----------------------
+// Fonte 5x7 própria, em colunas (bit 0 no topo), com acesso direto pelo
+// código ASCII. Cada caractere ocupa uma célula de 8 colunas numa página de
+// 8 linhas, então desenhar é copiar bytes inteiros para o buffer, sem
+// deslocamentos. Os números são formatados sem printf e os campos só são
+// redesenhados quando o valor muda. Não depende do pico-sdk.
+
+#define TEXT_CELL       8           // Largura de um caractere em colunas
+#define TEXT_ROW_WIDTH  128         // Colunas de uma página do SSD1306
+#define TEXT_COLS       (TEXT_ROW_WIDTH / TEXT_CELL)
+
+/**
+ * Desenha s a partir da coluna x de uma página (row aponta para a coluna 0).
+ * Para no fim da string, num '\n' ou no fim da página e retorna onde parou;
+ * um '\n' é consumido.
+ */
+const char *text_draw(uint8_t *row, int x, const char *s);
+
+/**
+ * Escreve value em decimal a partir de out, sem terminador. Retorna o fim.
+ */
+char *text_u32(char *out, uint32_t value);
+
+/** Copia s para out, sem terminador. Retorna o fim. */
+char *text_str(char *out, const char *s);
+
+/**
+ * Campo de largura fixa: guarda a chave do conteúdo exibido para só
+ * redesenhar quando ela mudar.
+ */
+typedef struct {
+    uint8_t page;
+    uint8_t x;                      // Coluna inicial
+    uint8_t chars;                  // Largura em caracteres
+    bool valid;
+    uintptr_t key;
+} text_field_t;
+
+/**
+ * Desenha s no campo se key diferir da última, limpando o resto do campo.
+ * Retorna true se o buffer mudou.
+ */
+bool text_field_draw(uint8_t *buffer, text_field_t *field, uintptr_t key, const char *s);
+
+static inline void text_field_invalidate(text_field_t *field) {
+    field->valid = false;
+}
+
+#endif
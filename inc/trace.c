@@ -0,0 +1,98 @@
+#include <string.h>
+
+#include "trace.h"
+
+static uint8_t *trace_put16(uint8_t *p, uint16_t value) {
+    p[0] = (uint8_t) value;
+    p[1] = (uint8_t)(value >> 8);
+    return p + 2;
+}
+
+static uint8_t *trace_put32(uint8_t *p, uint32_t value) {
+    return trace_put16(trace_put16(p, (uint16_t) value), (uint16_t)(value >> 16));
+}
+
+static uint16_t trace_get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t trace_get32(const uint8_t *p) {
+    return trace_get16(p) | (uint32_t) trace_get16(p + 2) << 16;
+}
+
+void trace_begin(trace_writer_t *writer, uint8_t *data, uint32_t capacity,
+                 const trace_header_t *header) {
+    uint8_t *p = data;
+    p = trace_put32(p, TRACE_MAGIC);
+    *p++ = TRACE_VERSION;
+    *p++ = header->difficulty;
+    *p++ = header->action;
+    *p++ = 0;
+    p = trace_put32(p, header->seed);
+    for (int i = 0; i < 4; i++)
+        p = trace_put16(p, header->stats_q8[i]);
+    p = trace_put32(p, header->next_step_ms);
+    trace_put16(p, header->rate_q8);
+    writer->data = data;
+    writer->capacity = capacity;
+    writer->len = TRACE_HEADER_LEN;
+    writer->last_us = 0;
+    writer->full = false;
+}
+
+bool trace_append(trace_writer_t *writer, const trace_event_t *event) {
+    if (writer->full || writer->capacity - writer->len < TRACE_EVENT_MAX) {
+        writer->full = true;
+        return false;
+    }
+    uint8_t *p = &writer->data[writer->len];
+    uint32_t delta = event->time_us - writer->last_us;
+    // LEB128: 7 bits por byte, bit 7 indica continuação.
+    while (delta >= 0x80) {
+        *p++ = (uint8_t)(delta | 0x80);
+        delta >>= 7;
+    }
+    *p++ = (uint8_t) delta;
+    *p++ = (uint8_t)((event->type & 0x0F) | event->source << 4);
+    writer->len = (uint32_t)(p - writer->data);
+    writer->last_us = event->time_us;
+    return true;
+}
+
+bool trace_open(trace_reader_t *reader, const uint8_t *data, uint32_t len,
+                trace_header_t *header) {
+    if (len < TRACE_HEADER_LEN || trace_get32(data) != TRACE_MAGIC || data[4] != TRACE_VERSION)
+        return false;
+    header->difficulty = data[5];
+    header->action = data[6];
+    header->seed = trace_get32(&data[8]);
+    for (int i = 0; i < 4; i++)
+        header->stats_q8[i] = trace_get16(&data[12 + 2 * i]);
+    header->next_step_ms = trace_get32(&data[20]);
+    header->rate_q8 = trace_get16(&data[24]);
+    reader->data = data;
+    reader->len = len;
+    reader->pos = TRACE_HEADER_LEN;
+    reader->time_us = 0;
+    return true;
+}
+
+bool trace_next(trace_reader_t *reader, trace_event_t *event) {
+    uint32_t delta = 0;
+    for (int shift = 0;; shift += 7) {
+        if (reader->pos >= reader->len || shift > 28)
+            return false;
+        uint8_t byte = reader->data[reader->pos++];
+        delta |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            break;
+    }
+    if (reader->pos >= reader->len)
+        return false;
+    uint8_t packed = reader->data[reader->pos++];
+    reader->time_us += delta;
+    event->time_us = reader->time_us;
+    event->type = packed & 0x0F;
+    event->source = packed >> 4;
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ---------------------- Traço de Entrada ----------------------
+// Gravação compacta das entradas entregues à interface, para reproduzi-las
+// depois com o mesmo tempo relativo. O cabeçalho guarda a semente do rand()
+// e o estado do Bob no início; cada evento ocupa o intervalo desde o
+// anterior em LEB128 (1 a 3 bytes em geral) e um byte com tipo e fonte.
+// O buffer é do chamador. Não depende do pico-sdk.
+
+#define TRACE_MAGIC         0x54424F42u     // "BOBT"
+#define TRACE_VERSION       1
+#define TRACE_HEADER_LEN    26
+#define TRACE_EVENT_MAX     6               // Intervalo de 32 bits + tipo/fonte
+
+typedef struct {
+    uint32_t seed;                  // Passada a srand() no início
+    uint16_t stats_q8[4];           // Atributos do Bob (Q8)
+    uint32_t next_step_ms;          // Fase do decaimento
+    uint16_t rate_q8;               // Queda por passo
+    uint8_t difficulty;
+    uint8_t action;                 // Item selecionado no menu principal
+} trace_header_t;
+
+typedef struct {
+    uint32_t time_us;               // Desde o início do traço
+    uint8_t type;                   // input_t
+    uint8_t source;                 // input_source_t
+} trace_event_t;
+
+typedef struct {
+    uint8_t *data;
+    uint32_t capacity;
+    uint32_t len;
+    uint32_t last_us;
+    bool full;                      // Um evento não coube; os seguintes são ignorados
+} trace_writer_t;
+
+typedef struct {
+    const uint8_t *data;
+    uint32_t len;
+    uint32_t pos;
+    uint32_t time_us;
+} trace_reader_t;
+
+/** Começa um traço em data, gravando o cabeçalho. */
+void trace_begin(trace_writer_t *writer, uint8_t *data, uint32_t capacity,
+                 const trace_header_t *header);
+
+/**
+ * Acrescenta um evento; time_us é relativo ao início e não pode voltar.
+ * Retorna false se não couber.
+ */
+bool trace_append(trace_writer_t *writer, const trace_event_t *event);
+
+/**
+ * Valida o cabeçalho e prepara a leitura. Retorna false se data não for um
+ * traço desta versão.
+ */
+bool trace_open(trace_reader_t *reader, const uint8_t *data, uint32_t len,
+                trace_header_t *header);
+
+/**
+ * Próximo evento. Retorna false no fim ou num evento truncado.
+ */
+bool trace_next(trace_reader_t *reader, trace_event_t *event);
+
+#endif
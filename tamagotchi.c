@@ -1,785 +1,2518 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include "pico/stdlib.h"
-#include "hardware/adc.h"
-#include "hardware/pwm.h"
-#include "hardware/pio.h"
-#include "hardware/clocks.h"
-#include "hardware/dma.h"
-#include "pico/critical_section.h"
-#include "ws2818b.pio.h"
-#include "inc/ssd1306.h"
-
-// ---------------------- Configurações Gerais ----------------------
-#define LED_COUNT         25
-#define LED_PIN           7
-
-#define LOWER_THRESHOLD   500
-#define UPPER_THRESHOLD   (4095 - 500)
-
-#define BUTTON_PIN        6           // Botão principal
-#define ERASE_BUTTON_PIN  5           // Botão extra
-
-#define RED_LED_PIN       13          // LED externo (vermelho)
-#define GREEN_LED_PIN     11          // LED externo (verde)
-#define BUZZER_PIN        21          // Buzzer (via PWM)
-
-#define FACE_COLOR_R      100
-#define FACE_COLOR_G      0
-#define FACE_COLOR_B      0
-
-#define I2C_SDA           14
-#define I2C_SCL           15
-
-#define DECAY_INTERVAL_MS 60000
-
-// ---------------------- Declarações e Variáveis Globais ----------------------
-typedef struct pixel {
-    uint8_t G, R, B;
-} pixel_t;
-pixel_t leds[LED_COUNT];
-
-PIO np_pio;
-uint sm;
-uint8_t led_dma_buffer[LED_COUNT * 3];
-int dma_channel;
-
-critical_section_t cs;
-
-int led_index(int row, int col) {
-    return (4 - row) * 5 + col;
-}
-
-typedef struct {
-    int fome;
-    int higiene;
-    int energia;
-    int diversao;
-} bob_status_t;
-bob_status_t bob = {75, 75, 75, 75};
-
-float decay_multiplier = 1.0f;
-uint32_t last_decay_ms = 0;
-
-// ---------------------- Faces do Bob ----------------------
-static const uint8_t face_happy[5][5] = {
-    {0, 1, 0, 1, 0},
-    {0, 1, 0, 1, 0},
-    {1, 0, 0, 0, 1},
-    {0, 1, 1, 1, 0},
-    {0, 0, 0, 0, 0}
-};
-
-static const uint8_t face_neutral[5][5] = {
-    {0, 1, 0, 1, 0},
-    {0, 1, 0, 1, 0},
-    {0, 0, 0, 0, 0},
-    {1, 1, 1, 1, 1},
-    {0, 0, 0, 0, 0}
-};
-
-static const uint8_t face_sad[5][5] = {
-    {0, 1, 0, 1, 0},
-    {0, 1, 0, 1, 0},
-    {0, 0, 0, 0, 0},
-    {0, 1, 1, 1, 0},
-    {1, 0, 0, 0, 1}
-};
-
-/**
- * Seleciona a face a ser exibida conforme os atributos do Bob.
- */
-const uint8_t (*select_face(void))[5] {
-    if (bob.fome < 30 || bob.higiene < 30 || bob.energia < 30 || bob.diversao < 30)
-        return face_sad;
-    int acima = 0, medio = 0;
-    if (bob.fome > 50) acima++; else medio++;
-    if (bob.higiene > 50) acima++; else medio++;
-    if (bob.energia > 50) acima++; else medio++;
-    if (bob.diversao > 50) acima++; else medio++;
-    return (acima > medio) ? face_happy : face_neutral;
-}
-
-// ---------------------- Funções para a Matriz de LEDs ----------------------
-void npInit(uint pin) {
-    uint offset = pio_add_program(pio0, &ws2818b_program);
-    np_pio = pio0;
-    sm = pio_claim_unused_sm(np_pio, false);
-    if (sm < 0) {
-        np_pio = pio1;
-        sm = pio_claim_unused_sm(np_pio, true);
-    }
-    ws2818b_program_init(np_pio, sm, offset, pin, 800000.f);
-    for (uint i = 0; i < LED_COUNT; i++) {
-        leds[i].R = 0;
-        leds[i].G = 0;
-        leds[i].B = 0;
-    }
-    critical_section_init(&cs);
-    dma_channel = dma_claim_unused_channel(true);
-}
-
-/**
- * Define a cor de um LED na posição indicada.
- */
-void npSetLED(const uint index, const uint8_t r, const uint8_t g, const uint8_t b) {
-    leds[index].R = r;
-    leds[index].G = g;
-    leds[index].B = b;
-}
-
-/**
- * Atualiza os LEDs via DMA.
- */
-void npWrite() {
-    for (int i = 0; i < LED_COUNT; i++) {
-        int base = i * 3;
-        led_dma_buffer[base + 0] = leds[i].G;
-        led_dma_buffer[base + 1] = leds[i].R;
-        led_dma_buffer[base + 2] = leds[i].B;
-    }
-    
-    dma_channel_config cfg = dma_channel_get_default_config(dma_channel);
-    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
-    channel_config_set_read_increment(&cfg, true);
-    channel_config_set_write_increment(&cfg, false);
-    channel_config_set_dreq(&cfg, pio_get_dreq(np_pio, sm, true));
-    
-    volatile void *fifo_addr = &np_pio->txf[sm];
-    
-    dma_channel_configure(
-        dma_channel,
-        &cfg,
-        (void *)fifo_addr,
-        led_dma_buffer,
-        LED_COUNT * 3,
-        true
-    );
-    
-    dma_channel_wait_for_finish_blocking(dma_channel);
-}
-
-/**
- * Desenha um padrão (por exemplo, a face do Bob) na matriz de LEDs.
- */
-void draw_pattern(const uint8_t pattern[5][5]) {
-    for (int row = 0; row < 5; row++) {
-        for (int col = 0; col < 5; col++) {
-            int index = led_index(row, col);
-            if (pattern[row][col])
-                npSetLED(index, FACE_COLOR_R, FACE_COLOR_G, FACE_COLOR_B);
-            else
-                npSetLED(index, 0, 0, 0);
-        }
-    }
-    npWrite();
-}
-
-// ---------------------- Funções do Buzzer ----------------------
-void pwm_init_buzzer(uint pin) {
-    gpio_set_function(pin, GPIO_FUNC_PWM);
-    uint slice_num = pwm_gpio_to_slice_num(pin);
-    pwm_config config = pwm_get_default_config();
-    pwm_config_set_clkdiv(&config, 4.0f);
-    pwm_init(slice_num, &config, true);
-    pwm_set_gpio_level(pin, 0);
-}
-
-void play_tone(uint pin, uint frequency, uint duration_ms) {
-    uint slice_num = pwm_gpio_to_slice_num(pin);
-    uint32_t clock_freq = clock_get_hz(clk_sys);
-    uint32_t top = clock_freq / frequency - 1;
-    pwm_set_wrap(slice_num, top);
-    pwm_set_gpio_level(pin, top / 2);
-    sleep_ms(duration_ms);
-    pwm_set_gpio_level(pin, 0);
-    sleep_ms(50);
-}
-
-void beep_success(void) {
-    play_tone(BUZZER_PIN, 800, 150);
-    sleep_ms(100);
-    play_tone(BUZZER_PIN, 800, 150);
-    sleep_ms(100);
-    play_tone(BUZZER_PIN, 800, 150);
-}
-
-void beep_failure(void) {
-    play_tone(BUZZER_PIN, 400, 800);
-    sleep_ms(100);
-    play_tone(BUZZER_PIN, 400, 800);
-    sleep_ms(100);
-    play_tone(BUZZER_PIN, 400, 1600);
-}
-
-void sound_menu_change(void) {
-    play_tone(BUZZER_PIN, 650, 80);
-}
-
-void sound_menu_confirm(void) {
-    play_tone(BUZZER_PIN, 750, 150);
-}
-
-// ---------------------- Funções Auxiliares para OLED ----------------------
-/**
- * Função auxiliar para dividir uma mensagem em duas linhas (até 16 caracteres cada).
- */
-void split_message(const char *msg, char *line1, char *line2) {
-    size_t len = strlen(msg);
-    memset(line1, 0, 17);
-    memset(line2, 0, 17);
-    if (len <= 16) {
-        strncpy(line1, msg, 16);
-    } else {
-        char *newline = strchr(msg, '\n');
-        if (newline != NULL) {
-            size_t len1 = newline - msg;
-            if (len1 > 16)
-                len1 = 16;
-            strncpy(line1, msg, len1);
-            strncpy(line2, newline + 1, 16);
-        } else {
-            strncpy(line1, msg, 16);
-            strncpy(line2, msg + 16, 16);
-        }
-    }
-}
-
-void update_oled_status(int selected_action, const char *action_names[],
-                        struct render_area *area, uint8_t *buffer) {
-    char line[64];
-    memset(buffer, 0, ssd1306_buffer_length);
-    
-    snprintf(line, sizeof(line), "Acao: %s", action_names[selected_action]);
-    ssd1306_draw_string(buffer, 0, 0, line);
-    
-    ssd1306_draw_string(buffer, 0, 10, "");
-    
-    snprintf(line, sizeof(line), "Fome:%d Hig:%d", bob.fome, bob.higiene);
-    ssd1306_draw_string(buffer, 0, 20, line);
-    snprintf(line, sizeof(line), "Ener:%d Div:%d", bob.energia, bob.diversao);
-    ssd1306_draw_string(buffer, 0, 30, line);
-    
-    ssd1306_draw_string(buffer, 0, 40, "----------------");
-    
-    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
-    uint32_t elapsed = now_ms - last_decay_ms;
-    uint32_t remaining_ms = (elapsed < DECAY_INTERVAL_MS) ? (DECAY_INTERVAL_MS - elapsed) : 0;
-    uint32_t seconds_remaining = remaining_ms / 1000;
-    snprintf(line, sizeof(line), "Prox: %lu s", seconds_remaining);
-    ssd1306_draw_string(buffer, 0, 50, line);
-    
-    render_on_display(buffer, area);
-}
-
-void display_message(const char *msg, struct render_area *area, uint8_t *buffer) {
-    char line1[17], line2[17];
-    memset(buffer, 0, ssd1306_buffer_length);
-    split_message(msg, line1, line2);
-    ssd1306_draw_string(buffer, 0, 0, line1);
-    if (strlen(line2) > 0)
-        ssd1306_draw_string(buffer, 0, 10, line2);
-    render_on_display(buffer, area);
-    sleep_ms(3000);
-}
-
-void update_oled_no_delay(const char *msg, struct render_area *area, uint8_t *buffer) {
-    char line1[17], line2[17];
-    memset(buffer, 0, ssd1306_buffer_length);
-    split_message(msg, line1, line2);
-    ssd1306_draw_string(buffer, 0, 0, line1);
-    if (strlen(line2) > 0)
-        ssd1306_draw_string(buffer, 0, 10, line2);
-    render_on_display(buffer, area);
-}
-
-// ---------------------- Funções do Jogo da Velha (Tic Tac Toe) ----------------------
-#define GRID_COLOR_R      255
-#define GRID_COLOR_G      255
-#define GRID_COLOR_B      255
-
-#define COLOR_OFF_R       0
-#define COLOR_OFF_G       0
-#define COLOR_OFF_B       0
-
-#define COLOR_PLAYER1_R   50    
-#define COLOR_PLAYER1_G   0
-#define COLOR_PLAYER1_B   0
-
-#define COLOR_PLAYER2_R   0    
-#define COLOR_PLAYER2_G   0
-#define COLOR_PLAYER2_B   50
-
-#define COLOR_CURSOR_R    50    
-#define COLOR_CURSOR_G    50
-#define COLOR_CURSOR_B    0
-
-int board[3][3] = { {0, 0, 0},
-                    {0, 0, 0},
-                    {0, 0, 0} };
-int current_player = 1;
-int cursor_row = 0;
-int cursor_col = 0;
-
-int led_index_game(int row, int col) {
-    return row * 5 + col;
-}
-
-void draw_board() {
-    for (int row = 0; row < 5; row++) {
-        for (int col = 0; col < 5; col++) {
-            int index = led_index_game(row, col);
-            if ((row % 2 == 0) && (col % 2 == 0)) {
-                int cell_row = row / 2;
-                int cell_col = col / 2;
-                if (cell_row == cursor_row && cell_col == cursor_col && current_player == 1)
-                    npSetLED(index, COLOR_CURSOR_R, COLOR_CURSOR_G, COLOR_CURSOR_B);
-                else if (board[cell_row][cell_col] == 1)
-                    npSetLED(index, COLOR_PLAYER1_R, COLOR_PLAYER1_G, COLOR_PLAYER1_B);
-                else if (board[cell_row][cell_col] == 2)
-                    npSetLED(index, COLOR_PLAYER2_R, COLOR_PLAYER2_G, COLOR_PLAYER2_B);
-                else
-                    npSetLED(index, COLOR_OFF_R, COLOR_OFF_G, COLOR_OFF_B);
-            } else {
-                npSetLED(index, GRID_COLOR_R, GRID_COLOR_G, GRID_COLOR_B);
-            }
-        }
-    }
-    npWrite();
-}
-
-int check_winner() {
-    // Verifica linhas e colunas
-    for (int i = 0; i < 3; i++) {
-        if (board[i][0] && board[i][0] == board[i][1] && board[i][1] == board[i][2])
-            return board[i][0];
-    }
-    for (int i = 0; i < 3; i++) {
-        if (board[0][i] && board[0][i] == board[1][i] && board[1][i] == board[2][i])
-            return board[0][i];
-    }
-    // Verifica diagonais
-    if (board[0][0] && board[0][0] == board[1][1] && board[1][1] == board[2][2])
-        return board[0][0];
-    if (board[0][2] && board[0][2] == board[1][1] && board[1][1] == board[2][0])
-        return board[0][2];
-    
-    int filled = 1;
-    for (int i = 0; i < 3; i++) 
-        for (int j = 0; j < 3; j++)
-            if (board[i][j] == 0)
-                filled = 0;
-    if (filled)
-        return -1;
-    
-    return 0;
-}
-
-void flash_win(int player) {
-    for (int i = 0; i < 6; i++) {
-        for (int row = 0; row < 5; row++) {
-            for (int col = 0; col < 5; col++) {
-                int index = led_index_game(row, col);
-                if ((row % 2 == 0) && (col % 2 == 0)) {
-                    if (player == 1)
-                        npSetLED(index, COLOR_PLAYER1_R, COLOR_PLAYER1_G, COLOR_PLAYER1_B);
-                    else if (player == 2)
-                        npSetLED(index, COLOR_PLAYER2_R, COLOR_PLAYER2_G, COLOR_PLAYER2_B);
-                } else {
-                    npSetLED(index, GRID_COLOR_R, GRID_COLOR_G, GRID_COLOR_B);
-                }
-            }
-        }
-        npWrite();
-        sleep_ms(300);
-        for (int row = 0; row < 5; row++) {
-            for (int col = 0; col < 5; col++) {
-                int index = led_index_game(row, col);
-                if ((row % 2 == 0) && (col % 2 == 0))
-                    npSetLED(index, COLOR_OFF_R, COLOR_OFF_G, COLOR_OFF_B);
-                else
-                    npSetLED(index, GRID_COLOR_R, GRID_COLOR_G, GRID_COLOR_B);
-            }
-        }
-        npWrite();
-        sleep_ms(300);
-    }
-}
-
-void flash_draw() {
-    for (int i = 0; i < 6; i++) {
-        for (int row = 0; row < 5; row++) {
-            for (int col = 0; col < 5; col++) {
-                int index = led_index_game(row, col);
-                if ((row % 2 == 0) && (col % 2 == 0))
-                    npSetLED(index, 200, 200, 200);
-                else
-                    npSetLED(index, GRID_COLOR_R, GRID_COLOR_G, GRID_COLOR_B);
-            }
-        }
-        npWrite();
-        sleep_ms(300);
-        for (int row = 0; row < 5; row++) {
-            for (int col = 0; col < 5; col++) {
-                int index = led_index_game(row, col);
-                if ((row % 2 == 0) && (col % 2 == 0))
-                    npSetLED(index, COLOR_OFF_R, COLOR_OFF_G, COLOR_OFF_B);
-                else
-                    npSetLED(index, GRID_COLOR_R, GRID_COLOR_G, GRID_COLOR_B);
-            }
-        }
-        npWrite();
-        sleep_ms(300);
-    }
-}
-
-void reset_game() {
-    memset(board, 0, sizeof(board));
-    cursor_row = 0;
-    cursor_col = 0;
-    current_player = 1;
-}
-
-bool ticTacToe_game(struct render_area *area, uint8_t *buffer) {
-    reset_game();
-    bool move_registered = false;
-    char direction[20];
-    int winner = 0;
-    
-    display_message("Jogo da Velha!\nSua vez", area, buffer);
-    
-    while (winner == 0) {
-        draw_board();
-        if (current_player == 1) {
-            adc_select_input(0);
-            uint16_t adc_y = adc_read();
-            adc_select_input(1);
-            uint16_t adc_x = adc_read();
-            
-            if (adc_x < LOWER_THRESHOLD)
-                strcpy(direction, "Direita");
-            else if (adc_x > UPPER_THRESHOLD)
-                strcpy(direction, "Esquerda");
-            else if (adc_y < LOWER_THRESHOLD)
-                strcpy(direction, "Cima");
-            else if (adc_y > UPPER_THRESHOLD)
-                strcpy(direction, "Baixo");
-            else
-                strcpy(direction, "Centro");
-            
-            if (strcmp(direction, "Centro") != 0 && !move_registered) {
-                if (strcmp(direction, "Esquerda") == 0)
-                    cursor_col = (cursor_col == 0) ? 2 : cursor_col - 1;
-                else if (strcmp(direction, "Direita") == 0)
-                    cursor_col = (cursor_col == 2) ? 0 : cursor_col + 1;
-                else if (strcmp(direction, "Cima") == 0)
-                    cursor_row = (cursor_row == 0) ? 2 : cursor_row - 1;
-                else if (strcmp(direction, "Baixo") == 0)
-                    cursor_row = (cursor_row == 2) ? 0 : cursor_row + 1;
-                sound_menu_change();
-                move_registered = true;
-                sleep_ms(300);
-            } else if (strcmp(direction, "Centro") == 0)
-                move_registered = false;
-            
-            bool button_pressed = !gpio_get(BUTTON_PIN);
-            if (button_pressed) {
-                if (board[cursor_row][cursor_col] == 0) {
-                    board[cursor_row][cursor_col] = 1;
-                    winner = check_winner();
-                    if (winner != 0)
-                        break;
-                    current_player = 2;
-                    sleep_ms(300);
-                }
-            }
-        } else {
-            int empty_cells[9][2], count = 0;
-            for (int i = 0; i < 3; i++)
-                for (int j = 0; j < 3; j++)
-                    if (board[i][j] == 0) {
-                        empty_cells[count][0] = i;
-                        empty_cells[count][1] = j;
-                        count++;
-                    }
-            if (count > 0) {
-                int r = rand() % count;
-                board[empty_cells[r][0]][empty_cells[r][1]] = 2;
-            }
-            winner = check_winner();
-            current_player = 1;
-            sleep_ms(500);
-        }
-        sleep_ms(50);
-    }
-    draw_board();
-    if (winner == 1) {
-        flash_win(1);
-        display_message("Voce venceu!", area, buffer);
-        beep_success();
-        return true;
-    } else if (winner == 2) {
-        flash_win(2);
-        display_message("Bob venceu!", area, buffer);
-        beep_failure();
-        return false;
-    } else {
-        flash_draw();
-        display_message("Empate!", area, buffer);
-        return false;
-    }
-}
-
-// ---------------------- Seletores de Menu ----------------------
-/**
- * Menu para selecionar o tipo de alimento.
- */
-int select_food_type(struct render_area *area, uint8_t *buffer) {
-    const char *food_names[3] = {"Refeicao", "Petisco", "Energetico"};
-    int selected = 0;
-    bool move_registered = false;
-    bool confirmed = false;
-    
-    while (!confirmed) {
-        char msg[32];
-        snprintf(msg, sizeof(msg), "Alimentar:\n%s", food_names[selected]);
-        update_oled_no_delay(msg, area, buffer);
-        
-        adc_select_input(1);
-        uint16_t adc_x = adc_read();
-        if (adc_x < LOWER_THRESHOLD && !move_registered) {
-            selected = (selected - 1 + 3) % 3;
-            sound_menu_change();
-            move_registered = true;
-        } else if (adc_x > UPPER_THRESHOLD && !move_registered) {
-            selected = (selected + 1) % 3;
-            sound_menu_change();
-            move_registered = true;
-        } else if (adc_x >= LOWER_THRESHOLD && adc_x <= UPPER_THRESHOLD)
-            move_registered = false;
-        
-        bool btn = !gpio_get(BUTTON_PIN);
-        if (btn) {
-            sound_menu_confirm();
-            sleep_ms(200);
-            confirmed = true;
-        }
-        sleep_ms(100);
-    }
-    return selected;
-}
-
-/**
- * Menu para selecionar a dificuldade.
- */
-float select_difficulty(struct render_area *area, uint8_t *buffer) {
-    const char *difficulty_names[3] = {"Facil", "Normal", "Dificil"};
-    float multipliers[3] = {0.8f, 1.0f, 1.5f};
-    int selected = 1; // Normal por default
-    bool move_registered = false;
-    bool confirmed = false;
-    
-    while (!confirmed) {
-        char msg[32];
-        snprintf(msg, sizeof(msg), "Dificuldade:\n%s", difficulty_names[selected]);
-        update_oled_no_delay(msg, area, buffer);
-        
-        adc_select_input(1);
-        uint16_t adc_x = adc_read();
-        if (adc_x < LOWER_THRESHOLD && !move_registered) {
-            selected = (selected - 1 + 3) % 3;
-            sound_menu_change();
-            move_registered = true;
-        } else if (adc_x > UPPER_THRESHOLD && !move_registered) {
-            selected = (selected + 1) % 3;
-            sound_menu_change();
-            move_registered = true;
-        } else if (adc_x >= LOWER_THRESHOLD && adc_x <= UPPER_THRESHOLD)
-            move_registered = false;
-        
-        bool btn = !gpio_get(BUTTON_PIN);
-        if (btn) {
-            sound_menu_confirm();
-            sleep_ms(200);
-            confirmed = true;
-        }
-        sleep_ms(100);
-    }
-    return multipliers[selected];
-}
-
-// ---------------------- Função de Decaimento ----------------------
-struct repeating_timer decay_timer;
-bool decay_timer_callback(struct repeating_timer *t) {
-    critical_section_enter_blocking(&cs);
-    int decay_val = (int)(5 * decay_multiplier);
-    bob.fome    = (bob.fome    >= decay_val) ? bob.fome - decay_val : 0;
-    bob.higiene = (bob.higiene >= decay_val) ? bob.higiene - decay_val : 0;
-    bob.energia = (bob.energia >= decay_val) ? bob.energia - decay_val : 0;
-    bob.diversao = (bob.diversao >= decay_val) ? bob.diversao - decay_val : 0;
-    critical_section_exit(&cs);
-    
-    last_decay_ms = to_ms_since_boot(get_absolute_time());
-    return true;
-}
-
-// ---------------------- Função Principal ----------------------
-int main() {
-    stdio_init_all();
-    srand((unsigned) to_ms_since_boot(get_absolute_time()));
-  
-    last_decay_ms = to_ms_since_boot(get_absolute_time());
-    npInit(LED_PIN);
-  
-    // Configuração dos LEDs externos
-    gpio_init(RED_LED_PIN);
-    gpio_set_dir(RED_LED_PIN, GPIO_OUT);
-    gpio_put(RED_LED_PIN, 0);
-    gpio_init(GREEN_LED_PIN);
-    gpio_set_dir(GREEN_LED_PIN, GPIO_OUT);
-    gpio_put(GREEN_LED_PIN, 0);
-  
-    // Inicializa ADC (joystick)
-    adc_init();
-    adc_gpio_init(26);
-    adc_gpio_init(27);
-  
-    // Configura os botões
-    gpio_init(BUTTON_PIN);
-    gpio_set_dir(BUTTON_PIN, GPIO_IN);
-    gpio_pull_up(BUTTON_PIN);
-    gpio_init(ERASE_BUTTON_PIN);
-    gpio_set_dir(ERASE_BUTTON_PIN, GPIO_IN);
-    gpio_pull_up(ERASE_BUTTON_PIN);
-  
-    // Inicializa o buzzer via PWM
-    pwm_init_buzzer(BUZZER_PIN);
-  
-    // Inicializa o display OLED via I2C (i2c1)
-    i2c_init(i2c1, ssd1306_i2c_clock * 1000);
-    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA);
-    gpio_pull_up(I2C_SCL);
-    ssd1306_init();
-  
-    // Configuração da área de renderização para o OLED
-    struct render_area frame_area = {
-        .start_column = 0,
-        .end_column   = ssd1306_width - 1,
-        .start_page   = 0,
-        .end_page     = ssd1306_n_pages - 1
-    };
-    calculate_render_area_buffer_length(&frame_area);
-    uint8_t oled_buffer[ssd1306_buffer_length];
-    memset(oled_buffer, 0, ssd1306_buffer_length);
-    render_on_display(oled_buffer, &frame_area);
-  
-    // Seletor de dificuldade
-    decay_multiplier = select_difficulty(&frame_area, oled_buffer);
-    {
-        char diffMsg[32];
-        if (decay_multiplier == 0.8f)
-            snprintf(diffMsg, sizeof(diffMsg), "Dificuldade: Facil");
-        else if (decay_multiplier == 1.0f)
-            snprintf(diffMsg, sizeof(diffMsg), "Dificuldade: Normal");
-        else if (decay_multiplier == 1.5f)
-            snprintf(diffMsg, sizeof(diffMsg), "Dificuldade: Dificil");
-        display_message(diffMsg, &frame_area, oled_buffer);
-    }
-  
-    add_repeating_timer_ms(DECAY_INTERVAL_MS, decay_timer_callback, NULL, &decay_timer);
-  
-    const char *action_names[4] = {"Alimentar", "Banho", "Dormir", "Brincar"};
-    const char *action_msgs[4]  = {"Bob alimentado!", "Bob tomou banho!",
-                                   "Bob Dormiu bastante", "Bob brincou!"};
-  
-    int selected_action = 0;
-    bool move_registered = false;
-    bool button_registered = false;
-  
-    while (true) {
-        adc_select_input(1);
-        uint16_t adc_x = adc_read();
-        if (adc_x < LOWER_THRESHOLD && !move_registered) {
-            selected_action = (selected_action - 1 + 4) % 4;
-            sound_menu_change();
-            move_registered = true;
-        } else if (adc_x > UPPER_THRESHOLD && !move_registered) {
-            selected_action = (selected_action + 1) % 4;
-            sound_menu_change();
-            move_registered = true;
-        } else if (adc_x >= LOWER_THRESHOLD && adc_x <= UPPER_THRESHOLD)
-            move_registered = false;
-      
-        update_oled_status(selected_action, action_names, &frame_area, oled_buffer);
-      
-        // Atualiza a face do Bob conforme seus status
-        const uint8_t (*face)[5] = select_face();
-        draw_pattern(face);
-      
-        bool button_pressed = !gpio_get(BUTTON_PIN);
-        if (button_pressed && !button_registered) {
-            sound_menu_confirm();
-            switch (selected_action) {
-                case 0: {
-                    int foodType = select_food_type(&frame_area, oled_buffer);
-                    if (foodType == 0) {
-                        bob.fome += 20;
-                        if (bob.fome > 100) bob.fome = 100;
-                        bob.energia += 5;
-                        if (bob.energia > 100) bob.energia = 100;
-                    } else if (foodType == 1) {
-                        bob.fome += 10;
-                        if (bob.fome > 100) bob.fome = 100;
-                    } else if (foodType == 2) {
-                        bob.fome += 5;
-                        if (bob.fome > 100) bob.fome = 100;
-                        bob.energia += 15;
-                        if (bob.energia > 100) bob.energia = 100;
-                    }
-                    display_message(action_msgs[0], &frame_area, oled_buffer);
-                    beep_success();
-                    break;
-                }
-                case 1:
-                    bob.higiene += 30;
-                    if (bob.higiene > 100) bob.higiene = 100;
-                    bob.diversao = (bob.diversao >= 5) ? bob.diversao - 5 : 0;
-                    display_message(action_msgs[1], &frame_area, oled_buffer);
-                    beep_success();
-                    break;
-                case 2:
-                    bob.energia += 25;
-                    if (bob.energia > 100) bob.energia = 100;
-                    display_message(action_msgs[2], &frame_area, oled_buffer);
-                    beep_success();
-                    break;
-                case 3: {
-                    bool win = ticTacToe_game(&frame_area, oled_buffer);
-                    if (win)
-                        bob.diversao += 20;
-                    else
-                        bob.diversao += 10;
-                    if (bob.diversao > 100) bob.diversao = 100;
-                    bob.energia = (bob.energia >= 10) ? bob.energia - 10 : 0;
-                    bob.fome = (bob.fome >= 5) ? bob.fome - 5 : 0;
-                    display_message("Bob brincou!", &frame_area, oled_buffer);
-                    beep_success();
-                    break;
-                }
-                default:
-                    break;
-            }
-            sleep_ms(300);
-            button_registered = true;
-        } else if (!button_pressed) {
-            button_registered = false;
-        }
-      
-        sleep_ms(50);
-    }
-  
-    return 0;
-}
\ No newline at end of file
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/adc.h"
+#include "hardware/pwm.h"
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/flash.h"
+#include "tusb.h"
+#include "ws2818b.pio.h"
+#include "inc/ssd1306.h"
+#include "inc/ssd1306_dma.h"
+#include "inc/scheduler.h"
+#include "inc/input.h"
+#include "inc/mnk.h"
+#include "inc/store.h"
+#include "inc/pet.h"
+#include "inc/pet_shared.h"
+#include "inc/anim.h"
+#include "inc/panel.h"
+#include "inc/text.h"
+#include "inc/trace.h"
+#include "inc/hist.h"
+#include "inc/prof.h"
+#include "inc/link.h"
+
+// ---------------------- Configurações Gerais ----------------------
+#define LED_WIDTH         5           // Matriz física (panel.h)
+#define LED_HEIGHT        5
+#define LED_ORDER         PANEL_ROW_MAJOR
+#define LED_ROTATION      PANEL_ROT_0
+#define LED_BOTTOM_FIRST  true
+#define LED_STRIPS        1           // Fitas em paralelo (até 8), uma por máquina de estado
+#define LED_COUNT         (LED_WIDTH * LED_HEIGHT)
+#define LED_STRIP_LEN     (LED_COUNT / LED_STRIPS)
+#define LED_PIN           7           // Fita 0; a fita i fica em LED_PIN + i
+#if LED_HEIGHT % LED_STRIPS != 0 || LED_STRIPS > 8
+#error "LED_STRIPS deve dividir LED_HEIGHT e caber nas 8 máquinas de estado"
+#endif
+#define LED_RESET_US      350         // Esvaziamento do FIFO do PIO + latch de reset do WS2812
+#define LED_BIT_HZ        800000.f    // Taxa de bits do WS2812
+#define LED_PIO_CYCLES_PER_BIT 10     // Ciclos do programa ws2818b por bit
+#define LED_BRIGHTNESS    255         // Brilho global (0-255) no modo ativo
+#define LED_DITHER        0           // Pontilhado temporal (1 = reenvio contínuo, sem __wfe no núcleo 1)
+#define LED_DITHER_US     2000        // Período de reenvio enquanto há pontilhado
+
+#define LOWER_THRESHOLD   500
+#define UPPER_THRESHOLD   (4095 - 500)
+
+#define BUTTON_PIN        6           // Botão principal
+#define ERASE_BUTTON_PIN  5           // Botão extra
+
+#define RED_LED_PIN       13          // LED externo (vermelho)
+#define GREEN_LED_PIN     11          // LED externo (verde)
+#define BUZZER_PIN        21          // Buzzer (via PWM)
+
+// As cores são perceptuais (antes da correção de gama).
+#define FACE_COLOR_R      167
+#define FACE_COLOR_G      0
+#define FACE_COLOR_B      0
+
+#define I2C_SDA           14
+#define I2C_SCL           15
+#define OLED_I2C_BAUD     1000000     // Fast-mode Plus para o envio por DMA
+#define OLED_POLL_US      2000        // Consulta de abort do I2C durante um envio
+
+#define DECAY_INTERVAL_MS 60000
+#define RENDER_MS         50          // Período de atualização do OLED e da matriz
+#define MESSAGE_MS        3000        // Tempo de exibição das mensagens
+#define BUTTON_DEBOUNCE_MS 20         // Janela em que repiques são ignorados
+#define BUTTON_LONG_MS    800         // Tempo para o toque longo
+#define BUTTON_DOUBLE_MS  350         // Intervalo máximo do toque duplo
+
+#define IDLE_TIMEOUT_MS   30000       // Sem entrada por este tempo: modo ocioso
+#define IDLE_RENDER_MS    1000        // Atualização da tela no modo ocioso
+#define IDLE_ERASE_MS     100         // Intervalo entre apagamentos de setor antes do modo ocioso
+#define ACTIVE_SYS_KHZ    125000      // clk_sys padrão do RP2040
+#define IDLE_SYS_KHZ      48000       // clk_sys no modo ocioso
+#define IDLE_LED_BRIGHTNESS 64        // Brilho global no modo ocioso (1/4)
+#define POWER_REPORT_MS   600000      // Intervalo do relatório de consumo
+
+// ---------------------- Declarações e Variáveis Globais ----------------------
+typedef struct pixel {
+    uint8_t G, R, B;
+} pixel_t;
+pixel_t leds[LED_COUNT];             // Ordem do quadro: as fitas uma depois da outra
+
+static const panel_layout_t led_panel = {
+    .width = LED_WIDTH, .height = LED_HEIGHT, .order = LED_ORDER,
+    .rotation = LED_ROTATION, .bottom_first = LED_BOTTOM_FIRST, .strips = LED_STRIPS,
+};
+
+// Cada fita tem sua máquina de estado e seu canal de DMA; todas partem
+// juntas, então o quadro leva o tempo de uma fita, não o da matriz inteira.
+typedef struct {
+    PIO pio;
+    uint sm;
+    int dma_channel;
+} np_strip_t;
+
+np_strip_t np_strips[LED_STRIPS];
+uint32_t np_dma_mask = 0;             // Canais de todas as fitas
+
+// Dois buffers de quadro: um é transmitido pelo DMA enquanto o outro é
+// preenchido. Cada pixel ocupa uma palavra, com G, R e B nos três bytes de
+// cima, que é o que o PIO desloca com autopull de 24 bits. A fita i lê o
+// trecho [i * LED_STRIP_LEN, (i + 1) * LED_STRIP_LEN). O driver roda
+// inteiro no núcleo 1.
+uint32_t led_dma_buffer[2][LED_COUNT];
+uint np_front = 0;                    // Buffer em transmissão (ou o último exibido)
+bool np_pending = false;              // O buffer de trás aguarda envio
+volatile uint32_t np_busy_mask = 0;   // Canais ainda transmitindo
+volatile bool np_in_flight = false;   // DMA em andamento
+volatile bool np_latching = false;    // Latch de reset após o DMA
+volatile uint32_t np_done_us = 0;     // Fim do último DMA
+pixel_t np_frame[LED_COUNT];          // Último quadro recebido, para reembalar
+
+// Gama e brilho global numa tabela em ponto fixo 8.8; a parte fracionária é
+// arredondada ou, com pontilhado, distribuída entre quadros sucessivos.
+// Gama 2,2 com brilho máximo: round((v / 255)^2,2 * 255 * 256).
+static const uint16_t np_gamma[256] = {
+    0, 0, 2, 4, 7, 11, 17, 24, 32, 42, 53, 65,
+    78, 94, 110, 128, 148, 169, 191, 216, 241, 269, 298, 328,
+    360, 394, 430, 467, 506, 547, 589, 633, 679, 726, 776, 827,
+    880, 934, 991, 1049, 1109, 1171, 1235, 1300, 1368, 1437, 1508, 1581,
+    1656, 1733, 1812, 1893, 1975, 2060, 2146, 2235, 2325, 2417, 2512, 2608,
+    2706, 2806, 2908, 3013, 3119, 3227, 3337, 3450, 3564, 3680, 3798, 3919,
+    4041, 4166, 4292, 4421, 4552, 4685, 4819, 4956, 5096, 5237, 5380, 5525,
+    5673, 5823, 5974, 6128, 6284, 6442, 6603, 6765, 6930, 7097, 7266, 7437,
+    7610, 7786, 7963, 8143, 8325, 8509, 8696, 8885, 9075, 9268, 9464, 9661,
+    9861, 10063, 10267, 10474, 10682, 10893, 11107, 11322, 11540, 11760, 11982, 12207,
+    12433, 12663, 12894, 13128, 13363, 13602, 13842, 14085, 14330, 14578, 14827, 15080,
+    15334, 15591, 15850, 16111, 16375, 16641, 16909, 17180, 17453, 17729, 18006, 18287,
+    18569, 18854, 19141, 19431, 19723, 20017, 20314, 20613, 20915, 21218, 21525, 21833,
+    22145, 22458, 22774, 23092, 23413, 23736, 24062, 24390, 24720, 25053, 25388, 25726,
+    26066, 26408, 26753, 27101, 27451, 27803, 28158, 28515, 28875, 29237, 29602, 29969,
+    30338, 30710, 31085, 31462, 31841, 32223, 32608, 32995, 33384, 33776, 34170, 34567,
+    34967, 35369, 35773, 36180, 36589, 37001, 37416, 37833, 38252, 38674, 39099, 39526,
+    39956, 40388, 40823, 41260, 41700, 42142, 42587, 43034, 43484, 43937, 44392, 44849,
+    45310, 45772, 46238, 46706, 47176, 47649, 48125, 48603, 49084, 49567, 50053, 50542,
+    51033, 51526, 52023, 52522, 53023, 53527, 54034, 54543, 55055, 55570, 56087, 56607,
+    57129, 57654, 58182, 58712, 59245, 59780, 60318, 60859, 61402, 61948, 62497, 63048,
+    63602, 64159, 64718, 65280
+};
+uint16_t np_lut[256];                 // Gama com o brilho atual
+bool np_dither = false;               // Pontilhado habilitado
+bool np_dithering = false;            // O quadro atual tem frações a pontilhar
+uint np_dither_phase = 0;
+static const uint8_t np_dither_bias[4] = {0, 128, 64, 192};
+
+// ---------------------- Perfil ----------------------
+// Trechos medidos (inc/prof.h), enviados e zerados pelo LINK_CMD_PROFILE do
+// protocolo da USB. A latência vai da detecção de uma entrada ao fim do envio do primeiro
+// quadro publicado depois dela.
+typedef enum {
+    PROF_LOOP,          // Volta do laço principal, sem a espera
+    PROF_UI,            // ui_render
+    PROF_LEDS,          // npWrite (núcleo 1)
+    PROF_OLED,          // oled_flush (núcleo 1)
+    PROF_ADC,           // Bloco do joystick (interrupção)
+    PROF_SOUND,         // Troca de nota (alarme)
+    PROF_GAME,          // Jogada do Bob
+    PROF_LATENCY,       // Entrada até o quadro exibido
+    PROF_COUNT
+} prof_id_t;
+
+#if PROF_ENABLED
+prof_section_t prof[PROF_COUNT] = {
+    [PROF_LOOP]    = PROF_SECTION("laco"),
+    [PROF_UI]      = PROF_SECTION("ui"),
+    [PROF_LEDS]    = PROF_SECTION("leds"),
+    [PROF_OLED]    = PROF_SECTION("oled"),
+    [PROF_ADC]     = PROF_SECTION("adc"),
+    [PROF_SOUND]   = PROF_SECTION("som"),
+    [PROF_GAME]    = PROF_SECTION("jogo"),
+    [PROF_LATENCY] = PROF_SECTION("latencia"),
+};
+#endif
+
+// Marca o quadro atual para ser publicado ao núcleo 1 (ver render_commit).
+void render_request(void);
+void render_tick(void *arg);
+
+// Publicado por seqlock (inc/pet_shared.h): o laço principal é o dono, e
+// os leitores sempre pegam um retrato inteiro.
+pet_shared_t bob;
+static const uint16_t bob_initial_q8[PET_STATS] = {
+    75 * PET_ONE, 75 * PET_ONE, 75 * PET_ONE, 75 * PET_ONE
+};
+
+// Relógio de 64 bits usado pelo decaimento (não dá a volta em 49 dias).
+static inline uint64_t uptime_ms(void) {
+    return time_us_64() / 1000;
+}
+
+// ---------------------- Faces do Bob ----------------------
+// Linhas de cima para baixo; a fita começa pela linha de baixo.
+#define FACE_FADE_MS      400         // Transição entre faces
+
+#define FACE_SPRITE(mask) {{{(mask), {FACE_COLOR_R, FACE_COLOR_G, FACE_COLOR_B}}}}
+
+static const anim_sprite_t face_happy = FACE_SPRITE(ANIM_ROWS(
+    0b01010,
+    0b01010,
+    0b10001,
+    0b01110,
+    0b00000));
+
+static const anim_sprite_t face_neutral = FACE_SPRITE(ANIM_ROWS(
+    0b01010,
+    0b01010,
+    0b00000,
+    0b11111,
+    0b00000));
+
+static const anim_sprite_t face_sad = FACE_SPRITE(ANIM_ROWS(
+    0b01010,
+    0b01010,
+    0b00000,
+    0b01110,
+    0b10001));
+
+/**
+ * Seleciona a face a ser exibida conforme os atributos do Bob.
+ */
+const anim_sprite_t *select_face(void) {
+    static const anim_sprite_t *const faces[] = {
+        [PET_SAD] = &face_sad, [PET_NEUTRAL] = &face_neutral, [PET_HAPPY] = &face_happy,
+    };
+    pet_view_t view;
+    pet_shared_view(&bob, uptime_ms(), &view);
+    return faces[pet_view_mood(&view)];
+}
+
+// ---------------------- Funções para a Matriz de LEDs ----------------------
+/**
+ * Dispara o envio do buffer de trás e o torna o buffer da frente.
+ * Deve ser chamada com o canal e o latch livres.
+ */
+static void np_start_transfer(void) {
+    np_front ^= 1;
+    np_pending = false;
+    np_in_flight = true;
+    np_busy_mask = np_dma_mask;
+    for (int i = 0; i < LED_STRIPS; i++) {
+        dma_channel_set_read_addr(np_strips[i].dma_channel,
+                                  &led_dma_buffer[np_front][i * LED_STRIP_LEN], false);
+        dma_channel_set_trans_count(np_strips[i].dma_channel, LED_STRIP_LEN, false);
+    }
+    dma_start_channel_mask(np_dma_mask);
+}
+
+/**
+ * Conclusão de um canal: o quadro termina com o último. Os últimos bytes
+ * ainda estão no FIFO do PIO, então o próximo quadro só é liberado após o
+ * esvaziamento e o latch de reset.
+ */
+static void np_dma_irq_handler(void) {
+    for (int i = 0; i < LED_STRIPS; i++) {
+        uint channel = (uint) np_strips[i].dma_channel;
+        if (!dma_channel_get_irq1_status(channel))
+            continue;
+        dma_channel_acknowledge_irq1(channel);
+        np_busy_mask &= ~(1u << channel);
+        if (np_busy_mask == 0) {
+            np_done_us = time_us_32();
+            np_latching = true;
+            np_in_flight = false;
+        }
+    }
+}
+
+/**
+ * Recalcula a tabela de cores para um brilho global (0-255).
+ */
+void np_set_brightness(uint8_t brightness) {
+    for (int v = 0; v < 256; v++)
+        np_lut[v] = (uint16_t)((uint32_t) np_gamma[v] * brightness / 255);
+}
+
+/**
+ * Empacota um quadro no buffer de trás, passando cada canal pela tabela.
+ */
+static void np_pack(const pixel_t *frame) {
+    uint32_t *back = led_dma_buffer[np_front ^ 1];
+    uint16_t fraction = 0;
+    for (int i = 0; i < LED_COUNT; i++) {
+        // Fase por pixel, para que os LEDs não pisquem juntos.
+        uint32_t bias = np_dither ? np_dither_bias[(np_dither_phase + i) & 3] : 128;
+        uint16_t g = np_lut[frame[i].G], r = np_lut[frame[i].R], b = np_lut[frame[i].B];
+        fraction |= g | r | b;
+        back[i] = ((g + bias) >> 8) << 24 | ((r + bias) >> 8) << 16 | ((b + bias) >> 8) << 8;
+    }
+    np_dither_phase++;
+    np_dithering = np_dither && (fraction & 0xFF) != 0;
+    np_pending = memcmp(back, led_dma_buffer[np_front], sizeof(led_dma_buffer[0])) != 0;
+}
+
+/**
+ * Envia o quadro pendente assim que o canal e o latch estiverem livres; com
+ * pontilhado, reenvia o quadro atual a cada LED_DITHER_US. Retorna true se
+ * o núcleo 1 ainda precisar voltar aqui sem esperar um evento.
+ */
+bool np_service(void) {
+    if (np_latching && time_us_32() - np_done_us >= LED_RESET_US)
+        np_latching = false;
+    if (np_dithering && !np_pending && !np_in_flight && !np_latching &&
+        time_us_32() - np_done_us >= LED_DITHER_US)
+        np_pack(np_frame);
+    if (np_pending && !np_in_flight && !np_latching)
+        np_start_transfer();
+    return np_pending || np_dithering;
+}
+
+/**
+ * Prepara a fita i no pino indicado: uma máquina de estado livre do pio0
+ * (ou do pio1, carregando o programa lá na primeira vez) e um canal de DMA.
+ */
+static void np_strip_init(int i, uint pin) {
+    static int offsets[2] = {-1, -1};   // Programa carregado em cada PIO
+    np_strip_t *strip = &np_strips[i];
+    strip->pio = pio0;
+    int sm = pio_claim_unused_sm(pio0, false);
+    if (sm < 0) {
+        strip->pio = pio1;
+        sm = pio_claim_unused_sm(pio1, true);
+    }
+    strip->sm = (uint) sm;
+    uint index = pio_get_index(strip->pio);
+    if (offsets[index] < 0)
+        offsets[index] = (int) pio_add_program(strip->pio, &ws2818b_program);
+    ws2818b_program_init(strip->pio, strip->sm, (uint) offsets[index], pin, LED_BIT_HZ);
+    // Um pixel por palavra do FIFO: autopull de 24 bits em vez de 8.
+    pio_sm_set_enabled(strip->pio, strip->sm, false);
+    hw_write_masked(&strip->pio->sm[strip->sm].shiftctrl,
+                    24u << PIO_SM0_SHIFTCTRL_PULL_THRESH_LSB, PIO_SM0_SHIFTCTRL_PULL_THRESH_BITS);
+    pio_sm_restart(strip->pio, strip->sm);
+    pio_sm_set_enabled(strip->pio, strip->sm, true);
+
+    strip->dma_channel = dma_claim_unused_channel(true);
+    np_dma_mask |= 1u << strip->dma_channel;
+
+    // O canal é configurado uma única vez; cada quadro só troca endereço e contagem.
+    dma_channel_config cfg = dma_channel_get_default_config(strip->dma_channel);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, pio_get_dreq(strip->pio, strip->sm, true));
+    dma_channel_configure(strip->dma_channel, &cfg, &strip->pio->txf[strip->sm],
+                          &led_dma_buffer[0][i * LED_STRIP_LEN], LED_STRIP_LEN, false);
+    dma_channel_set_irq1_enabled(strip->dma_channel, true);
+}
+
+void npInit(uint pin) {
+    for (int i = 0; i < LED_STRIPS; i++)
+        np_strip_init(i, pin + i);
+
+    np_set_brightness(LED_BRIGHTNESS);
+    np_dither = LED_DITHER;
+
+    // DMA_IRQ_1 é do núcleo 1 (LEDs e OLED); DMA_IRQ_0 fica com o ADC no núcleo 0.
+    irq_add_shared_handler(DMA_IRQ_1, np_dma_irq_handler,
+                           PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+}
+
+/**
+ * Define a cor de um LED na posição indicada.
+ */
+void npSetLED(const uint index, const uint8_t r, const uint8_t g, const uint8_t b) {
+    leds[index].R = r;
+    leds[index].G = g;
+    leds[index].B = b;
+}
+
+/**
+ * Prepara um quadro no buffer de trás; ele só é enviado se diferir do
+ * último. Roda no núcleo 1.
+ */
+void npWrite(const pixel_t *frame) {
+    PROF_BEGIN(start);
+    if (frame != np_frame)
+        memcpy(np_frame, frame, sizeof(np_frame));
+    np_pack(np_frame);
+    np_service();
+    PROF_END(&prof[PROF_LEDS], start);
+}
+
+// ---------------------- Animação da Matriz ----------------------
+// O player (inc/anim.h) guarda o quadro lógico da matriz; desenhos diretos,
+// como o tabuleiro, usam anim_canvas(). A tarefa de animação roda a cada
+// ANIM_FRAME_MS durante transições e dorme até a próxima chave no resto.
+// Numa matriz maior que a da animação, cada pixel do quadro vira um bloco
+// quadrado de LEDs, centralizado.
+#define LED_UNMAPPED      0xFF        // LED fora da imagem da animação
+
+anim_player_t led_anim;
+sched_task_t anim_task;
+uint8_t led_source[LED_COUNT];        // Pixel da animação exibido por cada LED
+
+/**
+ * Monta led_source[] a partir dos layouts da matriz e da animação.
+ */
+void led_map_init(void) {
+    uint16_t width = panel_width(&led_panel), height = panel_height(&led_panel);
+    uint16_t scale = (width < height ? width : height) / ANIM_SIDE;
+    uint16_t left = (width - scale * ANIM_SIDE) / 2, top = (height - scale * ANIM_SIDE) / 2;
+    memset(led_source, LED_UNMAPPED, sizeof(led_source));
+    for (uint16_t y = 0; y < scale * ANIM_SIDE; y++)
+        for (uint16_t x = 0; x < scale * ANIM_SIDE; x++)
+            led_source[panel_index(&led_panel, left + x, top + y)] =
+                (uint8_t) panel_index(&anim_panel, x / scale, y / scale);
+}
+
+/**
+ * Copia o quadro do player para leds[] e pede a publicação.
+ */
+void led_blit(void) {
+    for (int i = 0; i < LED_COUNT; i++) {
+        anim_rgb_t pixel = {0, 0, 0};
+        if (led_source[i] != LED_UNMAPPED)
+            pixel = led_anim.frame[led_source[i]];
+        npSetLED(i, pixel.r, pixel.g, pixel.b);
+    }
+    render_request();
+}
+
+void anim_tick(void *arg) {
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    if (anim_update(&led_anim, now_ms))
+        led_blit();
+    uint32_t next = anim_next_ms(&led_anim, now_ms);
+    if (next != ANIM_IDLE)
+        sched_after_ms(&anim_task, next, anim_tick, NULL);
+    else
+        sched_cancel(&anim_task);
+}
+
+/**
+ * Toca um clipe na matriz sem bloquear; done roda no laço principal ao fim.
+ */
+void led_play(const anim_clip_t *clip, anim_done_fn done) {
+    anim_play(&led_anim, clip, done, to_ms_since_boot(get_absolute_time()));
+    anim_tick(NULL);
+}
+
+/**
+ * Mostra uma face com transição a partir do que estiver na matriz.
+ */
+void face_show(const anim_sprite_t *face) {
+    anim_show(&led_anim, face, FACE_FADE_MS, to_ms_since_boot(get_absolute_time()));
+    if (!sched_pending(&anim_task))
+        anim_tick(NULL);
+}
+
+// ---------------------- Funções do Buzzer ----------------------
+void pwm_init_buzzer(uint pin) {
+    gpio_set_function(pin, GPIO_FUNC_PWM);
+    uint slice_num = pwm_gpio_to_slice_num(pin);
+    pwm_config config = pwm_get_default_config();
+    pwm_config_set_clkdiv(&config, 4.0f);
+    pwm_init(slice_num, &config, true);
+    pwm_set_gpio_level(pin, 0);
+}
+
+// ---------------------- Sequenciador de Notas ----------------------
+typedef struct {
+    uint16_t freq;          // Frequência em Hz (0 = pausa)
+    uint16_t duration_ms;
+} note_t;
+
+#define SOUND_QUEUE_LEN   32
+
+static note_t sound_queue[SOUND_QUEUE_LEN];
+static volatile uint sound_head = 0;      // Escrito pelo laço principal
+static volatile uint sound_tail = 0;      // Consumido pelo alarme
+static volatile alarm_id_t sound_alarm = 0;
+
+static const note_t melody_success[] = {
+    {800, 150}, {0, 150}, {800, 150}, {0, 150}, {800, 150}, {0, 50}
+};
+static const note_t melody_failure[] = {
+    {400, 800}, {0, 150}, {400, 800}, {0, 150}, {400, 1600}, {0, 50}
+};
+static const note_t melody_menu_change[]  = { {650, 80}, {0, 50} };
+static const note_t melody_menu_confirm[] = { {750, 150}, {0, 50} };
+
+/**
+ * Programa o PWM do buzzer para a frequência indicada (0 silencia).
+ */
+static void sound_output(uint frequency) {
+    if (frequency == 0) {
+        pwm_set_gpio_level(BUZZER_PIN, 0);
+        return;
+    }
+    uint slice_num = pwm_gpio_to_slice_num(BUZZER_PIN);
+    uint32_t clock_freq = clock_get_hz(clk_sys);
+    uint32_t top = clock_freq / frequency - 1;
+    pwm_set_wrap(slice_num, top);
+    pwm_set_gpio_level(BUZZER_PIN, top / 2);
+}
+
+/**
+ * Inicia a próxima nota da fila e retorna sua duração em us (0 se a fila acabou).
+ */
+static int64_t sound_next_note(void) {
+    if (sound_tail == sound_head) {
+        sound_output(0);
+        return 0;
+    }
+    note_t note = sound_queue[sound_tail % SOUND_QUEUE_LEN];
+    sound_tail++;
+    sound_output(note.freq);
+    return (int64_t)note.duration_ms * 1000;
+}
+
+/**
+ * Alarme do sequenciador: reagendado a partir do disparo anterior, sem deriva.
+ */
+static int64_t sound_alarm_callback(alarm_id_t id, void *user_data) {
+    PROF_BEGIN(start);
+    int64_t next_us = sound_next_note();
+    if (next_us == 0)
+        sound_alarm = 0;
+    PROF_END(&prof[PROF_SOUND], start);
+    // Valor negativo: o próximo disparo conta a partir do anterior.
+    return -next_us;
+}
+
+/**
+ * Enfileira uma melodia e retorna imediatamente. Notas além da capacidade
+ * da fila são descartadas.
+ */
+void sound_play(const note_t *melody, uint count) {
+    uint32_t irq_state = save_and_disable_interrupts();
+    for (uint i = 0; i < count && sound_head - sound_tail < SOUND_QUEUE_LEN; i++) {
+        sound_queue[sound_head % SOUND_QUEUE_LEN] = melody[i];
+        sound_head++;
+    }
+    if (sound_alarm == 0) {
+        int64_t first_us = sound_next_note();
+        if (first_us > 0)
+            sound_alarm = add_alarm_in_us(first_us, sound_alarm_callback, NULL, true);
+    }
+    restore_interrupts(irq_state);
+}
+
+/**
+ * Interrompe a melodia atual e descarta as notas pendentes.
+ */
+void sound_stop(void) {
+    uint32_t irq_state = save_and_disable_interrupts();
+    if (sound_alarm > 0)
+        cancel_alarm(sound_alarm);
+    sound_alarm = 0;
+    sound_tail = sound_head;
+    sound_output(0);
+    restore_interrupts(irq_state);
+}
+
+/**
+ * Substitui o que estiver tocando pela melodia indicada.
+ */
+void sound_replace(const note_t *melody, uint count) {
+    sound_stop();
+    sound_play(melody, count);
+}
+
+bool sound_busy(void) {
+    return sound_alarm != 0;
+}
+
+void beep_success(void) {
+    sound_play(melody_success, count_of(melody_success));
+}
+
+void beep_failure(void) {
+    sound_play(melody_failure, count_of(melody_failure));
+}
+
+void sound_menu_change(void) {
+    // A navegação corta o som anterior para manter o menu responsivo.
+    sound_replace(melody_menu_change, count_of(melody_menu_change));
+}
+
+void sound_menu_confirm(void) {
+    sound_replace(melody_menu_confirm, count_of(melody_menu_confirm));
+}
+
+// ---------------------- Funções Auxiliares para OLED ----------------------
+// Cada região enviada custa o byte de controle dos comandos, 6 bytes de
+// endereçamento e o byte de controle dos dados; intervalos iguais menores que
+// isso são enviados junto com a região vizinha.
+#define OLED_REGION_OVERHEAD  8
+
+typedef struct {
+    uint32_t frames;            // Quadros comparados
+    uint32_t regions;           // Regiões enviadas desde o boot
+    uint32_t last_frame_bytes;  // Bytes enviados no último quadro
+    uint32_t total_bytes;       // Bytes enviados desde o boot
+    uint32_t resends;           // Quadros inteiros reenviados após um abort
+} oled_stats_t;
+oled_stats_t oled_stats;
+
+// Cópia do conteúdo atual do painel.
+uint8_t oled_shadow[ssd1306_buffer_length];
+
+/**
+ * Enfileira um trecho contíguo de uma página no transporte por DMA e
+ * atualiza a cópia do painel. Retorna false se a fila estiver cheia.
+ */
+static bool oled_send_region(const uint8_t *buffer, uint page, uint col_start, uint col_end) {
+    struct render_area region = {
+        .start_column = col_start,
+        .end_column   = col_end,
+        .start_page   = page,
+        .end_page     = page
+    };
+    calculate_render_area_buffer_length(&region);
+    uint offset = page * ssd1306_width + col_start;
+    if (!ssd1306_dma_queue(&buffer[offset], &region))
+        return false;
+    memcpy(&oled_shadow[offset], &buffer[offset], region.buffer_length);
+    oled_stats.regions++;
+    oled_stats.last_frame_bytes += region.buffer_length + OLED_REGION_OVERHEAD;
+    return true;
+}
+
+/**
+ * Envia ao OLED apenas o que mudou dentro da área, página por página, em
+ * faixas de colunas. Retorna sem esperar o barramento; regiões que não
+ * couberem na fila continuam diferentes da cópia e vão no próximo quadro.
+ * Retorna o número de bytes enfileirados.
+ */
+uint32_t oled_flush(const uint8_t *buffer, const struct render_area *area) {
+    PROF_BEGIN(start);
+    oled_stats.frames++;
+    oled_stats.last_frame_bytes = 0;
+    bool queue_full = false;
+    for (uint page = area->start_page; page <= area->end_page && !queue_full; page++) {
+        const uint8_t *row = &buffer[page * ssd1306_width];
+        const uint8_t *shadow = &oled_shadow[page * ssd1306_width];
+        int run_start = -1, run_end = -1;
+        for (uint col = area->start_column; col <= area->end_column; col++) {
+            if (row[col] == shadow[col])
+                continue;
+            if (run_start >= 0 && (int)col - run_end > OLED_REGION_OVERHEAD) {
+                if (!oled_send_region(buffer, page, run_start, run_end)) {
+                    queue_full = true;
+                    break;
+                }
+                run_start = -1;
+            }
+            if (run_start < 0)
+                run_start = col;
+            run_end = col;
+        }
+        if (run_start >= 0 && !queue_full)
+            queue_full = !oled_send_region(buffer, page, run_start, run_end);
+    }
+    ssd1306_dma_submit();
+    oled_stats.total_bytes += oled_stats.last_frame_bytes;
+    PROF_END(&prof[PROF_OLED], start);
+    return oled_stats.last_frame_bytes;
+}
+
+/**
+ * Depois de um abort do DMA, o painel pode ter ficado com qualquer parte
+ * das regiões perdidas: reenvia a cópia inteira, que é o que ele deveria
+ * mostrar. Com a fila vazia pelo abort, o quadro inteiro cabe.
+ */
+static void oled_resend(void) {
+    struct render_area full = {
+        .start_column = 0,
+        .end_column   = ssd1306_width - 1,
+        .start_page   = 0,
+        .end_page     = ssd1306_n_pages - 1
+    };
+    if (ssd1306_dma_queue(oled_shadow, &full))
+        ssd1306_dma_submit();
+    oled_stats.resends++;
+}
+
+// Tela principal: a moldura é desenhada quando a tela é montada e cada
+// linha variável só é redesenhada quando os valores dela mudam.
+static bool status_layout = false;    // oled_buffer contém a moldura
+static text_field_t status_action = {.page = 0, .x = 6 * TEXT_CELL, .chars = TEXT_COLS - 6};
+static text_field_t status_fome   = {.page = 2, .x = 5 * TEXT_CELL, .chars = TEXT_COLS - 5};
+static text_field_t status_ener   = {.page = 3, .x = 5 * TEXT_CELL, .chars = TEXT_COLS - 5};
+static text_field_t status_next   = {.page = 6, .x = 6 * TEXT_CELL, .chars = TEXT_COLS - 6};
+
+/**
+ * Linha "<a> <rótulo><b>" de dois atributos; a chave junta os dois valores.
+ */
+static bool status_pair(uint8_t *buffer, text_field_t *field, int a, const char *label, int b) {
+    char line[TEXT_COLS + 1];
+    char *p = text_u32(line, a);
+    *p++ = ' ';
+    p = text_str(p, label);
+    *text_u32(p, b) = '\0';
+    return text_field_draw(buffer, field, (uintptr_t)(a << 8 | b), line);
+}
+
+void update_oled_status(const char *action_name, uint8_t *buffer) {
+    bool changed = false;
+    if (!status_layout) {
+        memset(buffer, 0, ssd1306_buffer_length);
+        text_draw(&buffer[0 * ssd1306_width], 0, "Acao: ");
+        text_draw(&buffer[2 * ssd1306_width], 0, "Fome:");
+        text_draw(&buffer[3 * ssd1306_width], 0, "Ener:");
+        text_draw(&buffer[5 * ssd1306_width], 0, "----------------");
+        text_draw(&buffer[6 * ssd1306_width], 0, "Prox: ");
+        text_field_invalidate(&status_action);
+        text_field_invalidate(&status_fome);
+        text_field_invalidate(&status_ener);
+        text_field_invalidate(&status_next);
+        status_layout = true;
+        changed = true;
+    }
+
+    changed |= text_field_draw(buffer, &status_action, (uintptr_t) action_name, action_name);
+
+    pet_view_t view;
+    pet_shared_view(&bob, uptime_ms(), &view);
+    changed |= status_pair(buffer, &status_fome, pet_view_get(&view, PET_FOME), "Hig:",
+                           pet_view_get(&view, PET_HIGIENE));
+    changed |= status_pair(buffer, &status_ener, pet_view_get(&view, PET_ENERGIA), "Div:",
+                           pet_view_get(&view, PET_DIVERSAO));
+
+    uint32_t seconds_remaining = view.next_step_ms / 1000;
+    char line[TEXT_COLS + 1];
+    *text_str(text_u32(line, seconds_remaining), " s") = '\0';
+    changed |= text_field_draw(buffer, &status_next, seconds_remaining, line);
+
+    if (changed)
+        render_request();
+}
+
+/**
+ * Mensagem de até duas linhas: quebra no '\n' ou no fim da primeira linha.
+ */
+void update_oled_no_delay(const char *msg, uint8_t *buffer) {
+    memset(buffer, 0, ssd1306_buffer_length);
+    status_layout = false;
+    const char *rest = text_draw(&buffer[0], 0, msg);
+    text_draw(&buffer[ssd1306_width], 0, rest);
+    render_request();
+}
+
+// ---------------------- Funções do Jogo da Velha (Tic Tac Toe) ----------------------
+#define GRID_COLOR_R      255
+#define GRID_COLOR_G      255
+#define GRID_COLOR_B      255
+
+#define COLOR_OFF_R       0
+#define COLOR_OFF_G       0
+#define COLOR_OFF_B       0
+
+#define COLOR_PLAYER1_R   122
+#define COLOR_PLAYER1_G   0
+#define COLOR_PLAYER1_B   0
+
+#define COLOR_PLAYER2_R   0    
+#define COLOR_PLAYER2_G   0
+#define COLOR_PLAYER2_B   122
+
+#define COLOR_CURSOR_R    122
+#define COLOR_CURSOR_G    122
+#define COLOR_CURSOR_B    0
+
+// Tabuleiros m,n,k (inc/mnk.h) com casas nos LEDs: o 3x3 usa as casas pares
+// da matriz com a grade entre elas; tabuleiros maiores usam todos os LEDs.
+mnk_rules_t game_rules;
+mnk_board_t board;
+mnk_engine_t game_engine;             // Inclui a tabela de transposição
+int current_player = 1;
+int cursor_row = 0;
+int cursor_col = 0;
+
+/**
+ * Posição no quadro da animação da linha e coluna da grade 5x5 do
+ * tabuleiro; a linha 0 fica embaixo.
+ */
+int led_index_game(int row, int col) {
+    return (int) panel_index(&anim_panel, (uint16_t) col, (uint16_t)(ANIM_SIDE - 1 - row));
+}
+
+static inline anim_rgb_t rgb(uint8_t r, uint8_t g, uint8_t b) {
+    return (anim_rgb_t){r, g, b};
+}
+
+/**
+ * Distância em LEDs entre casas vizinhas: 2 com grade, 1 sem.
+ */
+static int board_step(void) {
+    int side = game_rules.width > game_rules.height ? game_rules.width : game_rules.height;
+    return 2 * side - 1 <= ANIM_SIDE ? 2 : 1;
+}
+
+void draw_board() {
+    anim_rgb_t *canvas = anim_canvas(&led_anim);
+    sched_cancel(&anim_task);
+    int step = board_step();
+    for (int row = 0; row < ANIM_SIDE; row++) {
+        for (int col = 0; col < ANIM_SIDE; col++) {
+            int index = led_index_game(row, col);
+            int cell_row = row / step;
+            int cell_col = col / step;
+            if (cell_row >= game_rules.height || cell_col >= game_rules.width) {
+                canvas[index] = rgb(COLOR_OFF_R, COLOR_OFF_G, COLOR_OFF_B);
+            } else if (row % step == 0 && col % step == 0) {
+                int owner = mnk_owner(&board, mnk_cell(&game_rules, cell_row, cell_col));
+                if (cell_row == cursor_row && cell_col == cursor_col && current_player == 1)
+                    canvas[index] = rgb(COLOR_CURSOR_R, COLOR_CURSOR_G, COLOR_CURSOR_B);
+                else if (owner == 1)
+                    canvas[index] = rgb(COLOR_PLAYER1_R, COLOR_PLAYER1_G, COLOR_PLAYER1_B);
+                else if (owner == 2)
+                    canvas[index] = rgb(COLOR_PLAYER2_R, COLOR_PLAYER2_G, COLOR_PLAYER2_B);
+                else
+                    canvas[index] = rgb(COLOR_OFF_R, COLOR_OFF_G, COLOR_OFF_B);
+            } else {
+                canvas[index] = rgb(GRID_COLOR_R, GRID_COLOR_G, GRID_COLOR_B);
+            }
+        }
+    }
+    led_blit();
+}
+
+// Animação de fim de jogo: as casas piscam na cor do vencedor (branco no
+// empate) 6 vezes, com a grade no 3x3.
+#define FLASH_STEP_MS     300
+#define BOARD_CELLS       ANIM_ROWS(0b10101, 0b00000, 0b10101, 0b00000, 0b10101)
+#define BOARD_GRID        ANIM_ROWS(0b01010, 0b11111, 0b01010, 0b11111, 0b01010)
+#define BOARD_ALL         ANIM_ROWS(0b11111, 0b11111, 0b11111, 0b11111, 0b11111)
+#define BOARD_SPRITE(r, g, b) \
+    {{{BOARD_GRID, {GRID_COLOR_R, GRID_COLOR_G, GRID_COLOR_B}}, {BOARD_CELLS, {r, g, b}}}}
+#define BOARD_FULL_SPRITE(r, g, b) {{{0, {0, 0, 0}}, {BOARD_ALL, {r, g, b}}}}
+
+// [0] com grade, [1] sem.
+static const anim_sprite_t board_off[2] = {
+    BOARD_SPRITE(COLOR_OFF_R, COLOR_OFF_G, COLOR_OFF_B),
+    BOARD_FULL_SPRITE(COLOR_OFF_R, COLOR_OFF_G, COLOR_OFF_B),
+};
+static const anim_sprite_t board_lit[2][3] = {{
+    BOARD_SPRITE(228, 228, 228),
+    BOARD_SPRITE(COLOR_PLAYER1_R, COLOR_PLAYER1_G, COLOR_PLAYER1_B),
+    BOARD_SPRITE(COLOR_PLAYER2_R, COLOR_PLAYER2_G, COLOR_PLAYER2_B),
+}, {
+    BOARD_FULL_SPRITE(228, 228, 228),
+    BOARD_FULL_SPRITE(COLOR_PLAYER1_R, COLOR_PLAYER1_G, COLOR_PLAYER1_B),
+    BOARD_FULL_SPRITE(COLOR_PLAYER2_R, COLOR_PLAYER2_G, COLOR_PLAYER2_B),
+}};
+
+#define FLASH_KEYS(g, w) {{&board_lit[g][w], 0, FLASH_STEP_MS}, {&board_off[g], 0, FLASH_STEP_MS}}
+static const anim_key_t flash_keys[2][3][2] = {
+    {FLASH_KEYS(0, 0), FLASH_KEYS(0, 1), FLASH_KEYS(0, 2)},
+    {FLASH_KEYS(1, 0), FLASH_KEYS(1, 1), FLASH_KEYS(1, 2)},
+};
+static const anim_clip_t flash_clips[2][3] = {
+    {{flash_keys[0][0], 2, 6}, {flash_keys[0][1], 2, 6}, {flash_keys[0][2], 2, 6}},
+    {{flash_keys[1][0], 2, 6}, {flash_keys[1][1], 2, 6}, {flash_keys[1][2], 2, 6}},
+};
+
+void reset_game(int width, int height, int k) {
+    mnk_rules_init(&game_rules, width, height, k);
+    mnk_reset(&board);
+    // As posições guardadas valem só para estas regras.
+    mnk_engine_clear(&game_engine);
+    cursor_row = 0;
+    cursor_col = 0;
+    current_player = 1;
+}
+
+// ---------------------- Entrada (Joystick e Botão) ----------------------
+// O ADC converte Y (ADC0) e X (ADC1) em round-robin e o DMA grava as amostras
+// num buffer circular, interrompendo a cada bloco. O filtro roda nessa
+// interrupção e publica eventos tipados; ninguém mais toca no ADC.
+#define ADC_SAMPLE_HZ         4000      // Conversões por segundo (dois eixos)
+#define ADC_BLOCK_SAMPLES     8         // Amostras por interrupção (par: Y, X, Y, X...)
+#define ADC_IDLE_SAMPLE_HZ    800       // Amostragem no modo ocioso
+#define ADC_IDLE_BLOCK_SAMPLES 32       // O anel inteiro por interrupção (~25 Hz)
+#define ADC_RING_BITS         6         // Buffer circular de 2^6 bytes
+#define ADC_RING_LEN          ((1u << ADC_RING_BITS) / sizeof(uint16_t))
+#define INPUT_HYSTERESIS      300       // Margem para o eixo voltar ao centro
+#define INPUT_REPEAT_DELAY_MS 400       // Atraso até a primeira auto-repetição
+#define INPUT_REPEAT_MS       150       // Intervalo entre auto-repetições
+
+typedef struct {
+    int8_t state;           // -1 abaixo do limiar, 0 centro, +1 acima
+    uint32_t repeat_us;     // Instante da próxima auto-repetição
+} axis_filter_t;
+
+static uint16_t adc_ring[ADC_RING_LEN] __attribute__((aligned(1u << ADC_RING_BITS)));
+static uint adc_ring_pos = 0;           // Início do próximo bloco a filtrar
+static volatile uint adc_block = ADC_BLOCK_SAMPLES;  // Tamanho pedido do bloco
+static uint adc_armed_block = ADC_BLOCK_SAMPLES;     // Tamanho do bloco em curso
+static axis_filter_t axis_x, axis_y;
+int adc_dma_channel;
+input_queue_t joystick_queue;
+
+/**
+ * Aplica histerese a um eixo e publica a direção ao sair do centro e a cada
+ * auto-repetição enquanto o eixo for mantido.
+ */
+static void axis_filter_update(axis_filter_t *axis, uint16_t value,
+                               input_t low, input_t high, uint32_t now_us) {
+    int8_t state = axis->state;
+    if (value < LOWER_THRESHOLD)
+        state = -1;
+    else if (value > UPPER_THRESHOLD)
+        state = 1;
+    else if (value > LOWER_THRESHOLD + INPUT_HYSTERESIS &&
+             value < UPPER_THRESHOLD - INPUT_HYSTERESIS)
+        state = 0;
+
+    if (state != axis->state) {
+        axis->state = state;
+        if (state == 0)
+            return;
+        input_queue_push(&joystick_queue, state < 0 ? low : high, INPUT_SRC_JOYSTICK, now_us);
+        axis->repeat_us = now_us + INPUT_REPEAT_DELAY_MS * 1000;
+    } else if (state != 0 && (int32_t)(now_us - axis->repeat_us) >= 0) {
+        input_queue_push(&joystick_queue, state < 0 ? low : high, INPUT_SRC_JOYSTICK, now_us);
+        axis->repeat_us += INPUT_REPEAT_MS * 1000;
+    }
+}
+
+static void adc_dma_irq_handler(void) {
+    if (!dma_channel_get_irq0_status(adc_dma_channel))
+        return;
+    PROF_BEGIN(start);
+    dma_channel_acknowledge_irq0(adc_dma_channel);
+    // Rearma de imediato; o endereço de escrita segue dando a volta no anel.
+    uint block = adc_armed_block;
+    adc_armed_block = adc_block;
+    dma_channel_set_trans_count(adc_dma_channel, adc_armed_block, true);
+
+    uint32_t sum_y = 0, sum_x = 0;
+    for (uint i = 0; i < block; i += 2) {
+        sum_y += adc_ring[(adc_ring_pos + i) % ADC_RING_LEN];
+        sum_x += adc_ring[(adc_ring_pos + i + 1) % ADC_RING_LEN];
+    }
+    adc_ring_pos = (adc_ring_pos + block) % ADC_RING_LEN;
+
+    // Mapeamento do joystick: X baixo é "Direita", Y baixo é "Cima".
+    uint32_t now_us = time_us_32();
+    axis_filter_update(&axis_x, sum_x / (block / 2), INPUT_RIGHT, INPUT_LEFT, now_us);
+    axis_filter_update(&axis_y, sum_y / (block / 2), INPUT_UP, INPUT_DOWN, now_us);
+    PROF_END(&prof[PROF_ADC], start);
+}
+
+/**
+ * Muda a taxa de amostragem e o tamanho do bloco por interrupção. O novo
+ * bloco vale a partir da próxima recarga do DMA.
+ */
+void joystick_set_rate(uint sample_hz, uint block) {
+    adc_set_clkdiv(48000000.0f / sample_hz - 1);
+    adc_block = block;
+}
+
+/**
+ * Inicia a amostragem contínua do joystick (GPIO 26/27) por DMA.
+ */
+void joystick_sampler_init(void) {
+    adc_init();
+    adc_gpio_init(26);
+    adc_gpio_init(27);
+    adc_select_input(0);
+    adc_set_round_robin(0x3);
+    adc_fifo_setup(true, true, 1, false, false);
+    adc_set_clkdiv(48000000.0f / ADC_SAMPLE_HZ - 1);
+
+    input_queue_init(&joystick_queue);
+    if (!input_attach(&joystick_queue))
+        panic("input: filas demais");
+
+    adc_dma_channel = dma_claim_unused_channel(true);
+    dma_channel_config cfg = dma_channel_get_default_config(adc_dma_channel);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+    channel_config_set_read_increment(&cfg, false);
+    channel_config_set_write_increment(&cfg, true);
+    channel_config_set_ring(&cfg, true, ADC_RING_BITS);
+    channel_config_set_dreq(&cfg, DREQ_ADC);
+    dma_channel_configure(adc_dma_channel, &cfg, adc_ring, &adc_hw->fifo,
+                          ADC_BLOCK_SAMPLES, false);
+
+    dma_channel_set_irq0_enabled(adc_dma_channel, true);
+    irq_add_shared_handler(DMA_IRQ_0, adc_dma_irq_handler,
+                           PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+
+    adc_fifo_drain();
+    dma_channel_start(adc_dma_channel);
+    adc_run(true);
+}
+
+// Os botões geram interrupções nas duas bordas. A primeira borda que muda o
+// estado é aceita na hora (com seu timestamp); as seguintes são ignoradas
+// durante BUTTON_DEBOUNCE_MS, e ao fim da janela o nível é conferido.
+typedef struct {
+    uint pin;
+    input_source_t source;
+    bool pressed;               // Estado estável
+    bool settling;              // Dentro da janela de debounce
+    uint32_t last_press_us;     // Para detectar o toque duplo
+    alarm_id_t long_alarm;
+} button_t;
+
+button_t buttons[] = {
+    {.pin = BUTTON_PIN,       .source = INPUT_SRC_BUTTON},
+    {.pin = ERASE_BUTTON_PIN, .source = INPUT_SRC_ERASE},
+};
+input_queue_t button_queue;
+
+static int64_t button_long_alarm(alarm_id_t id, void *user_data) {
+    button_t *button = user_data;
+    button->long_alarm = 0;
+    if (button->pressed)
+        input_queue_push(&button_queue, INPUT_LONG_PRESS, button->source, time_us_32());
+    return 0;
+}
+
+/**
+ * Publica a mudança de estado estável de um botão.
+ */
+static void button_set_state(button_t *button, bool pressed, uint32_t now_us) {
+    button->pressed = pressed;
+    if (button->long_alarm > 0) {
+        cancel_alarm(button->long_alarm);
+        button->long_alarm = 0;
+    }
+    if (!pressed) {
+        input_queue_push(&button_queue, INPUT_RELEASE, button->source, now_us);
+        return;
+    }
+    input_queue_push(&button_queue, INPUT_PRESS, button->source, now_us);
+    if (now_us - button->last_press_us < BUTTON_DOUBLE_MS * 1000)
+        input_queue_push(&button_queue, INPUT_DOUBLE_PRESS, button->source, now_us);
+    button->last_press_us = now_us;
+    button->long_alarm = add_alarm_in_ms(BUTTON_LONG_MS, button_long_alarm, button, true);
+}
+
+/**
+ * Fim da janela de debounce: se o nível mudou durante ela, publica a borda perdida.
+ */
+static int64_t button_settle_alarm(alarm_id_t id, void *user_data) {
+    button_t *button = user_data;
+    button->settling = false;
+    bool pressed = !gpio_get(button->pin);
+    if (pressed != button->pressed) {
+        button_set_state(button, pressed, time_us_32());
+        button->settling = true;
+        return BUTTON_DEBOUNCE_MS * 1000;
+    }
+    return 0;
+}
+
+static void button_gpio_irq(uint gpio, uint32_t events) {
+    for (uint i = 0; i < count_of(buttons); i++) {
+        button_t *button = &buttons[i];
+        if (button->pin != gpio || button->settling)
+            continue;
+        bool pressed = !gpio_get(gpio);
+        if (pressed == button->pressed)
+            return;
+        button_set_state(button, pressed, time_us_32());
+        button->settling = true;
+        add_alarm_in_ms(BUTTON_DEBOUNCE_MS, button_settle_alarm, button, true);
+    }
+}
+
+/**
+ * Configura os botões (ativos em nível baixo) e suas interrupções de borda.
+ */
+void buttons_init(void) {
+    input_queue_init(&button_queue);
+    if (!input_attach(&button_queue))
+        panic("input: filas demais");
+    for (uint i = 0; i < count_of(buttons); i++) {
+        button_t *button = &buttons[i];
+        gpio_init(button->pin);
+        gpio_set_dir(button->pin, GPIO_IN);
+        gpio_pull_up(button->pin);
+        button->pressed = !gpio_get(button->pin);
+        gpio_set_irq_enabled_with_callback(button->pin, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE,
+                                           true, button_gpio_irq);
+    }
+}
+
+// ---------------------- Estados da Interface ----------------------
+typedef enum {
+    UI_DIFFICULTY,
+    UI_MAIN,
+    UI_SUBMENU,
+    UI_GAME,
+    UI_ANIMATION,
+    UI_MESSAGE,
+    UI_HISTORY
+} ui_state_t;
+
+typedef struct {
+    void (*on_input)(input_t input);
+    void (*render)(void);
+} ui_handler_t;
+
+struct render_area frame_area = {
+    .start_column = 0,
+    .end_column   = ssd1306_width - 1,
+    .start_page   = 0,
+    .end_page     = ssd1306_n_pages - 1
+};
+uint8_t oled_buffer[ssd1306_buffer_length];
+
+const char *difficulty_names[3] = {"Facil", "Normal", "Dificil"};
+// Queda por passo em Q8: 5 pontos x 0,8 / 1,0 / 1,5.
+const uint16_t difficulty_rates_q8[3] = {4 * PET_ONE, 5 * PET_ONE, 15 * PET_ONE / 2};
+
+ui_state_t ui_state = UI_DIFFICULTY;
+int selected_action = 0;
+int selected_item = 0;       // Item do submenu aberto
+int selected_difficulty = 1; // Normal por default
+bool game_started = false;   // Dificuldade escolhida (agora ou numa sessão salva)
+
+sched_task_t render_task;
+sched_task_t message_task;
+sched_task_t game_task;
+
+char message_text[33];
+void (*message_done)(void) = NULL;
+
+void ui_render(void);
+void bob_save(void);
+void settings_save(void);
+
+/**
+ * Passa para o menu principal.
+ */
+void ui_enter_main(void) {
+    ui_state = UI_MAIN;
+    ui_render();
+}
+
+/**
+ * Encerra a mensagem atual e segue para a continuação (ou o menu principal).
+ */
+void message_finish(void *arg) {
+    sched_cancel(&message_task);
+    void (*done)(void) = message_done;
+    message_done = NULL;
+    if (done != NULL)
+        done();
+    else
+        ui_enter_main();
+}
+
+/**
+ * Exibe uma mensagem por MESSAGE_MS sem bloquear; done é chamada ao final.
+ */
+void ui_show_message(const char *msg, void (*done)(void)) {
+    strncpy(message_text, msg, sizeof(message_text) - 1);
+    message_text[sizeof(message_text) - 1] = '\0';
+    message_done = done;
+    ui_state = UI_MESSAGE;
+    ui_render();
+    sched_after_ms(&message_task, MESSAGE_MS, message_finish, NULL);
+}
+
+void message_input(input_t input) {
+    // Os botões dispensam a mensagem antes do tempo.
+    if (input == INPUT_PRESS || input == INPUT_BACK)
+        message_finish(NULL);
+}
+
+void message_render(void) {
+    update_oled_no_delay(message_text, oled_buffer);
+}
+
+// ---------------------- Histórico dos Atributos ----------------------
+// Cada mudança dos atributos exibidos entra num anel em RAM (inc/hist.h):
+// ações e comandos logo depois de aplicados, passos de decaimento quando a
+// renderização os percebe, datados no instante em que venceram. No Normal,
+// um passo ocupa 3 bytes, e o anel de 4 KB guarda mais de 20 horas. O
+// joystick para baixo no menu principal abre um gráfico por atributo; o PC
+// lê o anel pelo LINK_CMD_HISTORY.
+#define HISTORY_LEN       4096        // Potência de 2
+#define HISTORY_BUCKET_S  300         // Segundos por coluna (104 colunas, 8,7 h)
+#define HISTORY_X         (3 * TEXT_CELL)   // Início dos gráficos, depois do rótulo
+#define HISTORY_HEIGHT    16          // Duas páginas por atributo
+
+uint8_t history_buffer[HISTORY_LEN];
+hist_t history;
+hist_spark_t history_spark;           // Lido só com a tela aberta
+bool history_layout = false;          // oled_buffer contém os rótulos
+
+static const char *const history_labels[PET_STATS] = {"Fom", "Hig", "Ene", "Div"};
+
+static uint32_t history_values(uint8_t values[PET_STATS]) {
+    pet_view_t view;
+    pet_shared_view(&bob, uptime_ms(), &view);
+    for (int i = 0; i < PET_STATS; i++)
+        values[i] = (uint8_t) pet_view_get(&view, (pet_stat_t) i);
+    return view.next_step_ms;
+}
+
+void history_init(void) {
+    uint8_t values[PET_STATS];
+    history_values(values);
+    hist_init(&history, history_buffer, sizeof(history_buffer), (uint32_t)(uptime_ms() / 1000),
+              values);
+}
+
+/**
+ * Registra o estado atual se ele mudou desde o último registro.
+ */
+void history_note(uint8_t kind) {
+    uint64_t now_ms = uptime_ms();
+    uint8_t values[PET_STATS];
+    uint32_t next_step_ms = history_values(values);
+    if (kind == HIST_DECAY)
+        now_ms -= DECAY_INTERVAL_MS - next_step_ms;
+    hist_append(&history, kind, (uint32_t)(now_ms / 1000), values);
+}
+
+void history_open(void) {
+    hist_spark_init(&history_spark, &history, HISTORY_BUCKET_S, (uint32_t)(uptime_ms() / 1000));
+    history_layout = false;
+    ui_state = UI_HISTORY;
+}
+
+void history_input(input_t input) {
+    if (input == INPUT_UP || input == INPUT_PRESS || input == INPUT_BACK)
+        ui_enter_main();
+}
+
+/**
+ * Desenha o rótulo, o valor atual e o gráfico de um atributo nas páginas
+ * 2 * stat e 2 * stat + 1. Cada coluna é ligada à anterior por um traço
+ * vertical.
+ */
+static void history_draw(uint8_t *buffer, int stat) {
+    uint8_t *top = &buffer[2 * stat * ssd1306_width];
+    memset(top, 0, 2 * ssd1306_width);
+    char value[4];
+    *text_u32(value, history_spark.current[stat]) = '\0';
+    text_draw(top, 0, history_labels[stat]);
+    text_draw(top + ssd1306_width, 0, value);
+
+    int prev = -1;
+    for (int col = 0; col < HIST_SPARK_COLS; col++) {
+        uint8_t v = history_spark.cols[stat][col];
+        if (v == HIST_NONE) {
+            prev = -1;
+            continue;
+        }
+        int y = HISTORY_HEIGHT - 1 - v * (HISTORY_HEIGHT - 1) / PET_MAX;
+        int from = prev < 0 ? y : prev;
+        for (int row = from < y ? from : y; row <= (from < y ? y : from); row++)
+            top[row / 8 * ssd1306_width + HISTORY_X + col] |= (uint8_t)(1u << (row % 8));
+        prev = y;
+    }
+}
+
+void history_render(void) {
+    bool changed = hist_spark_update(&history_spark, &history, (uint32_t)(uptime_ms() / 1000));
+    if (!history_layout) {
+        status_layout = false;
+        history_layout = true;
+        changed = true;
+    }
+    if (!changed)
+        return;
+    for (int i = 0; i < PET_STATS; i++)
+        history_draw(oled_buffer, i);
+    render_request();
+}
+
+// ---------------------- Tabela de Ações ----------------------
+// Cada ação do menu é uma linha constante (fica na flash): variação de cada
+// atributo, mensagem e som. Uma linha pode abrir um submenu ou o jogo.
+typedef enum { ACTION_EFFECT, ACTION_MENU, ACTION_GAME } action_kind_t;
+
+struct menu;
+
+/** Partida contra o Bob: tabuleiro, k em linha e nível de força (mnk_levels). */
+typedef struct {
+    const char *message;            // Abertura da partida
+    uint8_t width, height, k;
+    uint8_t level;
+} game_t;
+
+typedef struct {
+    const char *name;
+    const char *message;            // NULL = sem mensagem
+    int8_t delta[PET_STATS];        // Fome, higiene, energia, diversão
+    uint8_t kind;                   // action_kind_t
+    void (*sound)(void);            // Tocado após a confirmação (NULL = nenhum)
+    const struct menu *submenu;     // ACTION_MENU
+    const game_t *game;             // ACTION_GAME
+} action_t;
+
+typedef struct menu {
+    const char *title;
+    const action_t *items;
+    uint8_t count;
+} menu_t;
+
+static const action_t food_actions[] = {
+    {.name = "Refeicao",   .message = "Bob alimentado!", .delta = {20, 0,  5, 0}, .sound = beep_success},
+    {.name = "Petisco",    .message = "Bob alimentado!", .delta = {10, 0,  0, 0}, .sound = beep_success},
+    {.name = "Energetico", .message = "Bob alimentado!", .delta = { 5, 0, 15, 0}, .sound = beep_success},
+};
+static const menu_t food_menu = {"Alimentar", food_actions, count_of(food_actions)};
+
+static const game_t games[] = {
+    {"Jogo da Velha!\nSua vez", 3, 3, 3, MNK_EASY},
+    {"Jogo da Velha!\nSua vez", 3, 3, 3, MNK_NORMAL},
+    {"Jogo da Velha!\nSua vez", 3, 3, 3, MNK_HARD},
+    {"4 em linha!\nSua vez",    5, 5, 4, MNK_EASY},
+    {"4 em linha!\nSua vez",    5, 5, 4, MNK_NORMAL},
+    {"4 em linha!\nSua vez",    5, 5, 4, MNK_HARD},
+};
+
+static const action_t play_actions[] = {
+    {.name = "Velha Facil",     .kind = ACTION_GAME, .game = &games[0]},
+    {.name = "Velha Normal",    .kind = ACTION_GAME, .game = &games[1]},
+    {.name = "Velha Dificil",   .kind = ACTION_GAME, .game = &games[2]},
+    {.name = "4 Linha Facil",   .kind = ACTION_GAME, .game = &games[3]},
+    {.name = "4 Linha Normal",  .kind = ACTION_GAME, .game = &games[4]},
+    {.name = "4 Linha Dificil", .kind = ACTION_GAME, .game = &games[5]},
+};
+static const menu_t play_menu = {"Brincar", play_actions, count_of(play_actions)};
+
+static const action_t main_actions[] = {
+    {.name = "Alimentar", .kind = ACTION_MENU, .submenu = &food_menu},
+    {.name = "Banho",   .message = "Bob tomou banho!",    .delta = {0, 30,  0, -5}, .sound = beep_success},
+    {.name = "Dormir",  .message = "Bob Dormiu bastante", .delta = {0,  0, 25,  0}, .sound = beep_success},
+    {.name = "Brincar", .kind = ACTION_MENU, .submenu = &play_menu},
+};
+static const menu_t main_menu = {"Acao", main_actions, count_of(main_actions)};
+
+const menu_t *open_menu = NULL;
+
+void game_start(const game_t *game);
+
+/**
+ * Próximo índice de um menu circular: "Direita" volta, "Esquerda" avança.
+ */
+int menu_step(int index, int count, input_t input) {
+    return (index + (input == INPUT_LEFT ? 1 : count - 1)) % count;
+}
+
+/**
+ * Soma as variações da ação (saturadas em 0..100), mostra a mensagem e toca
+ * o som. done segue a mensagem, como em ui_show_message().
+ */
+void action_apply(const action_t *action, void (*done)(void)) {
+    history_note(HIST_DECAY);           // Um passo vencido não entra na ação
+    pet_shared_apply(&bob, action->delta, uptime_ms());
+    history_note(HIST_CHANGE);
+    if (action->message != NULL)
+        ui_show_message(action->message, done);
+    if (action->sound != NULL)
+        action->sound();
+}
+
+void action_select(const action_t *action) {
+    switch (action->kind) {
+        case ACTION_MENU:
+            open_menu = action->submenu;
+            selected_item = 0;
+            ui_state = UI_SUBMENU;
+            break;
+        case ACTION_GAME:
+            game_start(action->game);
+            break;
+        default:
+            action_apply(action, NULL);
+            break;
+    }
+}
+
+// Menu de dificuldade
+void difficulty_confirmed(void) {
+    pet_shared_start(&bob, difficulty_rates_q8[selected_difficulty], uptime_ms());
+    ui_enter_main();
+}
+
+void difficulty_input(input_t input) {
+    if (input == INPUT_BACK && game_started) {
+        // Desiste do jogo novo e volta ao Bob atual.
+        ui_enter_main();
+    } else if (input == INPUT_RIGHT || input == INPUT_LEFT) {
+        selected_difficulty = menu_step(selected_difficulty, count_of(difficulty_names), input);
+        sound_menu_change();
+    } else if (input == INPUT_PRESS) {
+        char msg[32];
+        sound_menu_confirm();
+        if (game_started) {
+            pet_shared_reset(&bob, bob_initial_q8);
+            history_note(HIST_RESET);
+        }
+        game_started = true;
+        settings_save();
+        bob_save();
+        snprintf(msg, sizeof(msg), "Dificuldade: %s", difficulty_names[selected_difficulty]);
+        ui_show_message(msg, difficulty_confirmed);
+    }
+}
+
+void difficulty_render(void) {
+    char msg[32];
+    snprintf(msg, sizeof(msg), "Dificuldade:\n%s", difficulty_names[selected_difficulty]);
+    update_oled_no_delay(msg, oled_buffer);
+}
+
+// Submenus (Alimentar)
+void submenu_input(input_t input) {
+    if (input == INPUT_RIGHT || input == INPUT_LEFT) {
+        selected_item = menu_step(selected_item, open_menu->count, input);
+        sound_menu_change();
+    } else if (input == INPUT_PRESS) {
+        sound_menu_confirm();
+        action_select(&open_menu->items[selected_item]);
+    } else if (input == INPUT_BACK) {
+        ui_enter_main();
+    }
+}
+
+void submenu_render(void) {
+    char msg[32];
+    snprintf(msg, sizeof(msg), "%s:\n%s", open_menu->title, open_menu->items[selected_item].name);
+    update_oled_no_delay(msg, oled_buffer);
+}
+
+// Jogo da Velha
+#define BOB_MOVE_DELAY_MS 350
+
+int game_winner = 0;
+const game_t *game = NULL;           // Partida em curso
+
+void game_played(void) {
+    ui_show_message("Bob brincou!", NULL);
+    beep_success();
+}
+
+// Efeito de uma partida: vitória do jogador, do Bob ou empate.
+static const action_t game_results[] = {
+    {.name = "Vitoria", .message = "Voce venceu!", .delta = {-5, 0, -10, 20}, .sound = beep_success},
+    {.name = "Derrota", .message = "Bob venceu!",  .delta = {-5, 0, -10, 10}, .sound = beep_failure},
+    {.name = "Empate",  .message = "Empate!",      .delta = {-5, 0, -10, 10}},
+};
+
+void game_finished(void) {
+    int result = game_winner == 1 ? 0 : game_winner == 2 ? 1 : 2;
+    action_apply(&game_results[result], game_played);
+    bob_save();
+}
+
+void game_over(int winner) {
+    game_winner = winner;
+    ui_state = UI_ANIMATION;
+    draw_board();
+    led_play(&flash_clips[board_step() == 1][winner == -1 ? 0 : winner], game_finished);
+}
+
+static uint32_t game_clock_us(void) {
+    return time_us_32();
+}
+
+/**
+ * Jogada do Bob: busca dentro dos limites do nível da partida; o rand()
+ * decide os lances ao acaso dos níveis mais fracos.
+ */
+void bob_move_task(void *arg) {
+    PROF_BEGIN(start);
+    mnk_result_t result;
+    int cell = mnk_search(&game_engine, &game_rules, &board, 2, &mnk_levels[game->level],
+                          (uint32_t) rand(), game_clock_us, &result);
+    if (cell >= 0)
+        mnk_play(&board, 2, cell);
+    PROF_END(&prof[PROF_GAME], start);
+    current_player = 1;
+    int winner = mnk_winner(&game_rules, &board);
+    if (winner != 0)
+        game_over(winner);
+    else
+        ui_render();
+}
+
+void game_begin(void) {
+    ui_state = UI_GAME;
+    ui_render();
+}
+
+void game_start(const game_t *selected) {
+    game = selected;
+    reset_game(game->width, game->height, game->k);
+    ui_show_message(game->message, game_begin);
+}
+
+void game_input(input_t input) {
+    if (current_player != 1)
+        return;
+    switch (input) {
+        case INPUT_LEFT:
+            cursor_col = (cursor_col == 0) ? game_rules.width - 1 : cursor_col - 1;
+            sound_menu_change();
+            break;
+        case INPUT_RIGHT:
+            cursor_col = (cursor_col == game_rules.width - 1) ? 0 : cursor_col + 1;
+            sound_menu_change();
+            break;
+        case INPUT_UP:
+            cursor_row = (cursor_row == 0) ? game_rules.height - 1 : cursor_row - 1;
+            sound_menu_change();
+            break;
+        case INPUT_DOWN:
+            cursor_row = (cursor_row == game_rules.height - 1) ? 0 : cursor_row + 1;
+            sound_menu_change();
+            break;
+        case INPUT_PRESS:
+            if (mnk_is_free(&game_rules, &board, mnk_cell(&game_rules, cursor_row, cursor_col))) {
+                mnk_play(&board, 1, mnk_cell(&game_rules, cursor_row, cursor_col));
+                int winner = mnk_winner(&game_rules, &board);
+                if (winner != 0) {
+                    game_over(winner);
+                    return;
+                }
+                current_player = 2;
+                sched_after_ms(&game_task, BOB_MOVE_DELAY_MS, bob_move_task, NULL);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void game_render(void) {
+    draw_board();
+}
+
+// Menu principal
+void main_input(input_t input) {
+    if (input == INPUT_RIGHT || input == INPUT_LEFT) {
+        selected_action = menu_step(selected_action, main_menu.count, input);
+        sound_menu_change();
+    } else if (input == INPUT_PRESS) {
+        sound_menu_confirm();
+        action_select(&main_menu.items[selected_action]);
+    } else if (input == INPUT_DOWN) {
+        sound_menu_confirm();
+        history_open();
+    }
+}
+
+void main_render(void) {
+    update_oled_status(main_menu.items[selected_action].name, oled_buffer);
+    // Atualiza a face do Bob conforme seus status
+    face_show(select_face());
+}
+
+void animation_input(input_t input) {
+    // A animação de fim de jogo não aceita entrada.
+}
+
+void animation_render(void) {
+    // Os quadros são emitidos pelos passos agendados da animação.
+}
+
+const ui_handler_t ui_handlers[] = {
+    [UI_DIFFICULTY] = {difficulty_input, difficulty_render},
+    [UI_MAIN]       = {main_input,       main_render},
+    [UI_SUBMENU]    = {submenu_input,    submenu_render},
+    [UI_GAME]       = {game_input,       game_render},
+    [UI_ANIMATION]  = {animation_input,  animation_render},
+    [UI_MESSAGE]    = {message_input,    message_render},
+    [UI_HISTORY]    = {history_input,    history_render},
+};
+
+void ui_render(void) {
+    PROF_BEGIN(start);
+    ui_handlers[ui_state].render();
+    PROF_END(&prof[PROF_UI], start);
+}
+
+void ui_dispatch(input_t input) {
+    ui_handlers[ui_state].on_input(input);
+    bob_save();
+    // Redesenha já, sem esperar pela próxima tarefa de renderização.
+    ui_render();
+}
+
+// ---------------------- Persistência ----------------------
+// O status do Bob e a dificuldade ficam no log da região reservada no fim
+// da flash (inc/store.h). Cada gravação programa uma página com o núcleo 1
+// e as interrupções travados por ~1 ms; setores obsoletos são apagados ao
+// entrar no modo ocioso.
+#define STORE_OFFSET (PICO_FLASH_SIZE_BYTES - STORE_SECTORS * FLASH_SECTOR_SIZE)
+
+enum { STORE_KEY_STATUS = 1, STORE_KEY_SETTINGS = 2 };
+
+static void store_flash_erase(uint32_t offset) {
+    multicore_lockout_start_blocking();
+    uint32_t irq_state = save_and_disable_interrupts();
+    flash_range_erase(STORE_OFFSET + offset, FLASH_SECTOR_SIZE);
+    restore_interrupts(irq_state);
+    multicore_lockout_end_blocking();
+}
+
+static void store_flash_program(uint32_t offset, const uint8_t *page) {
+    multicore_lockout_start_blocking();
+    uint32_t irq_state = save_and_disable_interrupts();
+    flash_range_program(STORE_OFFSET + offset, page, FLASH_PAGE_SIZE);
+    restore_interrupts(irq_state);
+    multicore_lockout_end_blocking();
+}
+
+static const store_flash_t store_flash = {
+    .base    = (const uint8_t *)(XIP_BASE + STORE_OFFSET),
+    .sectors = STORE_SECTORS,
+    .erase   = store_flash_erase,
+    .program = store_flash_program,
+};
+
+store_t store;
+uint16_t bob_saved[PET_STATS];      // Último status gravado (Q8)
+
+static void bob_pack(uint16_t packed[PET_STATS]) {
+    pet_view_t view;
+    pet_shared_view(&bob, uptime_ms(), &view);
+    memcpy(packed, view.q8, sizeof(view.q8));
+}
+
+/**
+ * Grava o status se ele mudou desde a última gravação. Com o decaimento
+ * calculado na leitura, muda no máximo uma vez por passo sem interação.
+ */
+void bob_save(void) {
+    uint16_t packed[PET_STATS];
+    bob_pack(packed);
+    if (!game_started || memcmp(packed, bob_saved, sizeof(packed)) == 0)
+        return;
+    if (store_write(&store, STORE_KEY_STATUS, packed, sizeof(packed)))
+        memcpy(bob_saved, packed, sizeof(packed));
+}
+
+void settings_save(void) {
+    uint8_t settings[1] = {(uint8_t) selected_difficulty};
+    store_write(&store, STORE_KEY_SETTINGS, settings, sizeof(settings));
+}
+
+/**
+ * Restaura o status e a dificuldade salvos. Retorna true se havia uma
+ * dificuldade escolhida.
+ */
+bool store_load(void) {
+    store_mount(&store, &store_flash);
+    uint16_t packed[PET_STATS];
+    if (store_read(&store, STORE_KEY_STATUS, packed, sizeof(packed)) == sizeof(packed))
+        pet_shared_reset(&bob, packed);
+    bob_pack(bob_saved);
+
+    uint8_t settings[1];
+    if (store_read(&store, STORE_KEY_SETTINGS, settings, sizeof(settings)) != sizeof(settings) ||
+        settings[0] >= count_of(difficulty_rates_q8))
+        return false;
+    selected_difficulty = settings[0];
+    game_started = true;
+    return true;
+}
+
+/**
+ * Abre o seletor de dificuldade para recomeçar; o Bob atual só é
+ * substituído quando a escolha for confirmada.
+ */
+void new_game_select(void) {
+    ui_state = UI_DIFFICULTY;
+    ui_render();
+}
+
+// ---------------------- Modo de Energia ----------------------
+// O núcleo 0 decide o modo e o núcleo 1 o aplica entre duas transferências,
+// já que o clk_sys também move os divisores do PIO e do I2C.
+typedef enum { POWER_ACTIVE, POWER_IDLE } power_mode_t;
+
+static uint32_t power_request = POWER_ACTIVE;   // Escrito só pelo núcleo 0
+static uint32_t power_applied = POWER_ACTIVE;   // Escrito só pelo núcleo 1
+
+/**
+ * Aplica o modo pedido pelo núcleo 0 com a saída parada: sem DMA, com o FIFO
+ * do PIO esvaziado (fim do latch) e com o controlador I2C ocioso. Roda no
+ * núcleo 1. Retorna true se um modo pedido ainda espera a saída parar.
+ */
+static bool power_service(void) {
+    uint32_t mode = __atomic_load_n(&power_request, __ATOMIC_ACQUIRE);
+    if (mode == power_applied)
+        return false;
+    if (np_in_flight || np_latching || ssd1306_dma_busy())
+        return true;
+    set_sys_clock_khz(mode == POWER_IDLE ? IDLE_SYS_KHZ : ACTIVE_SYS_KHZ, true);
+    for (int i = 0; i < LED_STRIPS; i++)
+        pio_sm_set_clkdiv(np_strips[i].pio, np_strips[i].sm,
+                          clock_get_hz(clk_sys) / (LED_PIO_CYCLES_PER_BIT * LED_BIT_HZ));
+    i2c_set_baudrate(i2c1, OLED_I2C_BAUD);
+
+    // O pontilhado reenviaria quadros sem parar; fica só no modo ativo.
+    np_set_brightness(mode == POWER_IDLE ? IDLE_LED_BRIGHTNESS : LED_BRIGHTNESS);
+    np_dither = LED_DITHER && mode == POWER_ACTIVE;
+    npWrite(np_frame);
+    __atomic_store_n(&power_applied, mode, __ATOMIC_RELEASE);
+    __sev();
+    return false;
+}
+
+// ---------------------- Renderização no Núcleo 1 ----------------------
+// O núcleo 0 desenha em leds[] e oled_buffer e publica cópias completas num
+// anel de quadros; o núcleo 1 é dono do PIO, do I2C e dos DMAs de saída e
+// exibe sempre o quadro mais recente. O anel usa só loads e stores com
+// barreira (o M0+ não tem instruções atômicas) e deixa o FIFO entre os
+// núcleos livre.
+#define RENDER_RING_LEN 4
+
+typedef struct {
+    pixel_t leds[LED_COUNT];
+    uint8_t oled[ssd1306_buffer_length];
+    bool input;                     // Primeiro quadro após uma entrada
+    uint32_t input_us;              // Instante da entrada (perfil de latência)
+} render_frame_t;
+
+static render_frame_t render_ring[RENDER_RING_LEN];
+static uint32_t render_head = 0;      // Escrito só pelo núcleo 0
+static uint32_t render_tail = 0;      // Escrito só pelo núcleo 1
+static bool render_dirty = false;
+static bool latency_pending = false;  // Entrada ainda sem quadro publicado
+static uint32_t latency_input_us;
+
+/**
+ * Marca o instante de uma entrada para medir até o quadro que a reflete.
+ */
+static void latency_note_input(uint32_t time_us) {
+    if (PROF_ENABLED && !latency_pending) {
+        latency_pending = true;
+        latency_input_us = time_us;
+    }
+}
+
+void render_request(void) {
+    render_dirty = true;
+}
+
+/**
+ * Publica o quadro desenhado, se houver. Com o anel cheio, tenta de novo na
+ * próxima volta do laço; o núcleo 1 sinaliza com SEV ao liberar espaço.
+ */
+void render_commit(void) {
+    if (!render_dirty) {
+        // A entrada não mudou nada na tela: não há quadro a medir.
+        latency_pending = false;
+        return;
+    }
+    uint32_t head = render_head;
+    if (head - __atomic_load_n(&render_tail, __ATOMIC_ACQUIRE) >= RENDER_RING_LEN)
+        return;
+    render_frame_t *frame = &render_ring[head % RENDER_RING_LEN];
+    memcpy(frame->leds, leds, sizeof(leds));
+    memcpy(frame->oled, oled_buffer, sizeof(oled_buffer));
+    frame->input = latency_pending;
+    frame->input_us = latency_input_us;
+    latency_pending = false;
+    __atomic_store_n(&render_head, head + 1, __ATOMIC_RELEASE);
+    render_dirty = false;
+    __sev();
+}
+
+static void render_core_init(void) {
+    // Permite ao núcleo 0 pausar este núcleo durante gravações na flash.
+    multicore_lockout_victim_init();
+    npInit(LED_PIN);
+
+    i2c_init(i2c1, ssd1306_i2c_clock * 1000);
+    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA);
+    gpio_pull_up(I2C_SCL);
+    ssd1306_init();
+    // A cópia do painel começa zerada; limpa o painel para casar com ela.
+    render_on_display(oled_shadow, &frame_area);
+    ssd1306_dma_init(i2c1, OLED_I2C_BAUD);
+}
+
+/**
+ * Laço do núcleo 1. Quadros intermediários são descartados; o último fica
+ * retido até todas as suas regiões do OLED caberem na fila do DMA.
+ */
+static void render_core_main(void) {
+    render_core_init();
+    uint32_t tail = 0;
+    bool holding = false;
+    uint32_t oled_aborts = 0;
+#if PROF_ENABLED
+    bool latency_open = false;        // Quadro com entrada ainda em envio
+    uint32_t latency_us = 0;
+#endif
+    while (true) {
+        uint32_t head = __atomic_load_n(&render_head, __ATOMIC_ACQUIRE);
+        const render_frame_t *frame = &render_ring[tail % RENDER_RING_LEN];
+        if (head - tail > (uint32_t) holding) {
+#if PROF_ENABLED
+            // Quadros descartados passam a marca da entrada adiante.
+            for (uint32_t i = tail + holding; i != head && !latency_open; i++) {
+                if (render_ring[i % RENDER_RING_LEN].input) {
+                    latency_open = true;
+                    latency_us = render_ring[i % RENDER_RING_LEN].input_us;
+                }
+            }
+#endif
+            tail = head - 1;
+            holding = true;
+            __atomic_store_n(&render_tail, tail, __ATOMIC_RELEASE);
+            frame = &render_ring[tail % RENDER_RING_LEN];
+            npWrite(frame->leds);
+            oled_flush(frame->oled, &frame_area);
+        } else if (holding && !ssd1306_dma_busy()) {
+            oled_flush(frame->oled, &frame_area);
+        }
+        if (holding && memcmp(oled_shadow, frame->oled, ssd1306_buffer_length) == 0) {
+            holding = false;
+            __atomic_store_n(&render_tail, ++tail, __ATOMIC_RELEASE);
+            __sev();
+        }
+
+#if PROF_ENABLED
+        if (latency_open && !holding && !ssd1306_dma_busy() && !np_pending && !np_in_flight) {
+            latency_open = false;
+            prof_record(&prof[PROF_LATENCY], time_us_32() - latency_us);
+        }
+#endif
+
+        bool oled_waiting = ssd1306_dma_service();
+        if (ssd1306_dma_aborts() != oled_aborts) {
+            oled_aborts = ssd1306_dma_aborts();
+            oled_resend();
+            oled_waiting = true;
+        }
+        bool power_waiting = power_service();
+
+        // Acorda com um novo quadro (SEV), com o fim de um DMA ou com o fim
+        // do latch dos LEDs. O esvaziamento do FIFO do I2C não gera evento,
+        // então uma troca de modo pendente volta a conferir após um latch;
+        // um abort do I2C também não, e é conferido a cada OLED_POLL_US.
+        if (np_service() || power_waiting)
+            best_effort_wfe_or_timeout(make_timeout_time_us(LED_RESET_US));
+        else if (oled_waiting)
+            best_effort_wfe_or_timeout(make_timeout_time_us(OLED_POLL_US));
+        else
+            __wfe();
+    }
+}
+
+// ---------------------- Modo Ocioso ----------------------
+// Sem entrada por IDLE_TIMEOUT_MS, o clk_sys cai, os LEDs escurecem, o
+// joystick passa a ser amostrado devagar e a tela só é redesenhada quando o
+// contador regressivo muda de segundo. O laço principal então dorme até o
+// próximo prazo, uma borda de botão ou um bloco do ADC.
+sched_task_t idle_task;
+sched_task_t power_report_task;
+bool idle_mode = false;
+uint64_t idle_since_us = 0;
+uint64_t idle_total_us = 0;
+
+void link_report(const char *fmt, ...);
+
+/**
+ * Pede um modo ao núcleo 1 e espera ele ser aplicado, para que o PWM do
+ * buzzer não calcule notas com o clock antigo.
+ */
+static void power_set(power_mode_t mode) {
+    __atomic_store_n(&power_request, mode, __ATOMIC_RELEASE);
+    __sev();
+    while (__atomic_load_n(&power_applied, __ATOMIC_ACQUIRE) != mode)
+        __wfe();
+}
+
+/**
+ * Redesenha e se reagenda para a próxima virada de segundo do contador
+ * regressivo do decaimento.
+ */
+static void idle_render_tick(void *arg) {
+    history_note(HIST_DECAY);
+    ui_render();
+    bob_save();
+    pet_view_t view;
+    pet_shared_view(&bob, uptime_ms(), &view);
+    uint32_t delay = view.next_step_ms % IDLE_RENDER_MS + 1;
+    sched_after_ms(&render_task, delay, idle_render_tick, NULL);
+}
+
+static void idle_enter(void *arg) {
+    // Melodias, animações e jogadas em andamento adiam o modo ocioso.
+    if (sound_busy() || ui_state == UI_ANIMATION ||
+        sched_pending(&game_task) || sched_pending(&message_task) ||
+        sched_pending(&anim_task)) {
+        sched_after_ms(&idle_task, 1000, idle_enter, NULL);
+        return;
+    }
+    // Apaga os setores obsoletos do armazenamento longe da interação, um por
+    // vez: cada apagamento desliga as IRQs e para o núcleo 1 por dezenas de
+    // ms, e uma entrada entre eles rearma o prazo.
+    if (store_service(&store)) {
+        sched_after_ms(&idle_task, IDLE_ERASE_MS, idle_enter, NULL);
+        return;
+    }
+    idle_mode = true;
+    idle_since_us = time_us_64();
+    power_set(POWER_IDLE);
+    joystick_set_rate(ADC_IDLE_SAMPLE_HZ, ADC_IDLE_BLOCK_SAMPLES);
+    idle_render_tick(NULL);
+}
+
+static void idle_exit(void) {
+    idle_mode = false;
+    idle_total_us += time_us_64() - idle_since_us;
+    power_set(POWER_ACTIVE);
+    joystick_set_rate(ADC_SAMPLE_HZ, ADC_BLOCK_SAMPLES);
+    sched_every_ms(&render_task, RENDER_MS, render_tick, NULL);
+}
+
+/**
+ * Chamada a cada evento de entrada: sai do modo ocioso e rearma o prazo.
+ */
+static void idle_note_input(void) {
+    if (idle_mode)
+        idle_exit();
+    sched_after_ms(&idle_task, IDLE_TIMEOUT_MS, idle_enter, NULL);
+}
+
+/**
+ * Relata, desde o último relatório, a fração do tempo dormindo em
+ * sched_wait, a fração em modo ocioso e os despertares por minuto.
+ */
+static void power_report_tick(void *arg) {
+    static sched_stats_t last;
+    static uint64_t last_us, last_idle_us;
+    uint64_t now_us = time_us_64();
+    uint64_t idle_us = idle_total_us + (idle_mode ? now_us - idle_since_us : 0);
+    sched_stats_t stats = sched_get_stats();
+
+    uint64_t span = now_us - last_us;
+    link_report("Energia: %.1f%% dormindo, %.1f%% ocioso, %.1f despertares/min",
+           100.0 * (stats.sleep_us - last.sleep_us) / span,
+           100.0 * (idle_us - last_idle_us) / span,
+           (stats.wakeups - last.wakeups) * 60e6 / span);
+    link_report("Flash: %lu paginas, %lu setores apagados, pior gravacao %lu us",
+           (unsigned long) store.stats.writes, (unsigned long) store.stats.erases,
+           (unsigned long) store.stats.max_write_us);
+
+    last = stats;
+    last_us = now_us;
+    last_idle_us = idle_us;
+}
+
+// ---------------------- Traço de Entrada ----------------------
+// Grava as entradas entregues à interface (inc/trace.h) e as reproduz com o
+// mesmo tempo relativo, a mesma semente do rand() e o mesmo estado inicial
+// do Bob, o que repete as transições e os quadros. Gravação e reprodução
+// partem do menu principal, com a fase das tarefas periódicas e o perfil
+// zerados; durante a reprodução, as entradas reais são ignoradas. O PC
+// comanda e transfere o traço pelo protocolo da USB (LINK_CMD_TRACE).
+#define TRACE_BUFFER_LEN  4096
+
+typedef enum { TRACE_IDLE, TRACE_RECORDING, TRACE_REPLAYING } trace_mode_t;
+
+uint8_t trace_buffer[TRACE_BUFFER_LEN];
+trace_mode_t trace_mode = TRACE_IDLE;
+trace_writer_t trace_writer;
+trace_reader_t trace_reader;
+trace_header_t trace_header;
+trace_event_t trace_next_event;
+bool trace_has_next = false;
+uint32_t trace_loaded = 0;          // Bytes recebidos do PC
+uint32_t trace_played = 0;
+uint64_t trace_start_us;
+input_queue_t trace_queue;          // Eventos reproduzidos
+sched_task_t trace_task;
+
+void input_dispatch(void);
+
+/**
+ * Leva o firmware ao ponto de partida descrito pelo cabeçalho.
+ */
+static void trace_restart(const trace_header_t *header) {
+    srand(header->seed);
+    pet_shared_write_begin(&bob);
+    pet_init(&bob.pet, header->stats_q8, DECAY_INTERVAL_MS);
+    bob.pet.rate_q8 = header->rate_q8;
+    bob.pet.anchor_ms = uptime_ms() + header->next_step_ms - DECAY_INTERVAL_MS;
+    pet_shared_write_end(&bob);
+    history_note(HIST_RESET);
+    selected_difficulty = header->difficulty;
+    selected_action = header->action;
+    idle_note_input();
+    sched_every_ms(&render_task, RENDER_MS, render_tick, NULL);
+#if PROF_ENABLED
+    for (int i = 0; i < PROF_COUNT; i++)
+        prof_reset(&prof[i]);
+#endif
+    ui_enter_main();
+    trace_start_us = time_us_64();
+}
+
+/**
+ * Começa a gravar a partir do estado atual. Só no menu principal.
+ */
+static bool trace_record(void) {
+    if (trace_mode != TRACE_IDLE || ui_state != UI_MAIN)
+        return false;
+    pet_view_t view;
+    pet_shared_view(&bob, uptime_ms(), &view);
+    pet_t pet;
+    pet_shared_read(&bob, &pet);
+    trace_header_t header = {
+        .seed = time_us_32(),
+        .next_step_ms = view.next_step_ms,
+        .rate_q8 = pet.rate_q8,
+        .difficulty = (uint8_t) selected_difficulty,
+        .action = (uint8_t) selected_action,
+    };
+    memcpy(header.stats_q8, view.q8, sizeof(view.q8));
+    // A gravação passa pelo mesmo ponto de partida da reprodução.
+    trace_restart(&header);
+    trace_begin(&trace_writer, trace_buffer, sizeof(trace_buffer), &header);
+    trace_loaded = 0;
+    trace_mode = TRACE_RECORDING;
+    return true;
+}
+
+static void trace_note_input(const input_event_t *event) {
+    trace_event_t entry = {
+        .time_us = (uint32_t)(time_us_64() - trace_start_us),
+        .type = event->type,
+        .source = event->source,
+    };
+    if (!trace_append(&trace_writer, &entry))
+        trace_mode = TRACE_IDLE;        // Buffer cheio: o traço termina aqui
+}
+
+/**
+ * Entrega os eventos vencidos da reprodução e agenda o próximo.
+ */
+static void trace_play_tick(void *arg) {
+    uint64_t now_us = time_us_64();
+    while (trace_has_next && trace_start_us + trace_next_event.time_us <= now_us) {
+        input_queue_push(&trace_queue, (input_t) trace_next_event.type,
+                         (input_source_t)(trace_next_event.source | INPUT_SRC_REPLAYED),
+                         time_us_32());
+        trace_played++;
+        trace_has_next = trace_next(&trace_reader, &trace_next_event);
+    }
+    input_dispatch();
+    if (trace_has_next) {
+        sched_at_us(&trace_task, trace_start_us + trace_next_event.time_us, trace_play_tick, NULL);
+    } else {
+        trace_mode = TRACE_IDLE;
+        link_report("Traco: %lu eventos reproduzidos em %lu ms", (unsigned long) trace_played,
+               (unsigned long)((now_us - trace_start_us) / 1000));
+    }
+}
+
+static void trace_play_start(void *arg) {
+    trace_restart(&trace_header);
+    trace_played = 0;
+    trace_has_next = trace_next(&trace_reader, &trace_next_event);
+    trace_play_tick(NULL);
+}
+
+/**
+ * Reproduz o traço carregado. Só no menu principal.
+ */
+static bool trace_play(void) {
+    if (trace_mode != TRACE_IDLE || ui_state != UI_MAIN ||
+        !trace_open(&trace_reader, trace_buffer, trace_loaded, &trace_header) ||
+        trace_header.next_step_ms > DECAY_INTERVAL_MS)
+        return false;
+    // A âncora do decaimento não pode ficar antes do boot: logo após ligar,
+    // a reprodução espera o relógio permitir a mesma fase.
+    uint64_t now_ms = uptime_ms();
+    uint32_t lead_ms = DECAY_INTERVAL_MS - trace_header.next_step_ms;
+    trace_mode = TRACE_REPLAYING;
+    sched_after_ms(&trace_task, now_ms < lead_ms ? (uint32_t)(lead_ms - now_ms) : 0,
+                   trace_play_start, NULL);
+    return true;
+}
+
+// ---------------------- Tarefas Periódicas ----------------------
+/**
+ * Entrega à interface os eventos publicados pelas interrupções. O botão
+ * extra funciona como "voltar".
+ */
+void input_dispatch(void) {
+    input_event_t event;
+    while (input_poll(&event)) {
+        if (trace_mode == TRACE_REPLAYING) {
+            // As entradas reais mudariam o resultado da reprodução.
+            if (!(event.source & INPUT_SRC_REPLAYED))
+                continue;
+            event.source &= ~INPUT_SRC_REPLAYED;
+        } else if (trace_mode == TRACE_RECORDING) {
+            trace_note_input(&event);
+        }
+        idle_note_input();
+        latency_note_input(event.time_us);
+        if (event.source == INPUT_SRC_ERASE) {
+            if (event.type == INPUT_PRESS)
+                ui_dispatch(INPUT_BACK);
+            else if (event.type == INPUT_LONG_PRESS && ui_state == UI_MAIN)
+                new_game_select();
+        } else {
+            ui_dispatch(event.type);
+        }
+    }
+}
+
+/**
+ * Redesenha a tela; o decaimento aparece aqui, calculado na leitura, e é
+ * registrado no histórico e gravado quando muda.
+ */
+void render_tick(void *arg) {
+    history_note(HIST_DECAY);
+    ui_render();
+    bob_save();
+}
+
+// ---------------------- Telemetria pela USB ----------------------
+// Protocolo de inc/link.h sobre o CDC do TinyUSB. Sem o stdio USB: o laço
+// principal roda o tud_task e é o único a mexer no TinyUSB, e os relatórios
+// em texto viajam em quadros LINK_TEXT, então nada se mistura aos quadros.
+// O laço gera os quadros num anel e o esvazia só até onde o FIFO do CDC
+// aceita; o resto sai na volta seguinte ou numa nova tentativa, então um PC
+// lento ou ausente nunca segura o firmware. A interrupção da USB acorda o
+// laço, que copia os bytes recebidos para o anel de entrada.
+#define LINK_TX_RETRY_MS  2           // Nova tentativa com o FIFO do CDC cheio
+
+link_t usb_link;
+input_queue_t link_queue;             // Entradas injetadas pelo PC
+sched_task_t telemetry_task;
+sched_task_t link_tx_task;
+
+/**
+ * Passa ao CDC o que couber do anel de saída. Sem PC conectado, descarta.
+ */
+static void link_flush(void *arg) {
+    const uint8_t *data;
+    uint32_t len;
+    while ((len = link_ring_peek(&usb_link.tx, &data)) > 0) {
+        uint32_t n = len;
+        if (tud_cdc_connected()) {
+            uint32_t room = tud_cdc_write_available();
+            n = tud_cdc_write(data, len < room ? len : room);
+            if (n == 0)
+                break;
+        }
+        link_ring_consume(&usb_link.tx, n);
+    }
+    tud_cdc_write_flush();
+    if (link_ring_used(&usb_link.tx) > 0)
+        sched_after_ms(&link_tx_task, LINK_TX_RETRY_MS, link_flush, NULL);
+}
+
+/**
+ * Envia um relatório em texto num quadro LINK_TEXT, cortado em
+ * LINK_PAYLOAD_MAX bytes. Sem PC conectado, descarta.
+ */
+void link_report(const char *fmt, ...) {
+    char text[LINK_PAYLOAD_MAX + 1];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+    if (len > LINK_PAYLOAD_MAX)
+        len = LINK_PAYLOAD_MAX;
+    if (len > 0 && tud_cdc_connected())
+        link_send(&usb_link, LINK_TEXT, text, (uint32_t) len);
+}
+
+static void telemetry_tick(void *arg) {
+    uint8_t payload[LINK_TM_LEN] = {0};
+    uint64_t now_ms = uptime_ms();
+    pet_view_t view;
+    pet_shared_view(&bob, now_ms, &view);
+    link_put32(&payload[LINK_TM_UPTIME], (uint32_t) now_ms);
+    for (int i = 0; i < PET_STATS; i++)
+        link_put16(&payload[LINK_TM_STATS + 2 * i], view.q8[i]);
+    link_put32(&payload[LINK_TM_NEXT_STEP], view.next_step_ms);
+
+    uint8_t *ui = &payload[LINK_TM_UI];
+    ui[0] = (uint8_t) ui_state;
+    ui[1] = ui_state != UI_SUBMENU ? 0 : open_menu == &food_menu ? 1 : 2;
+    ui[2] = (uint8_t)(ui_state == UI_SUBMENU ? selected_item :
+                      ui_state == UI_DIFFICULTY ? selected_difficulty : selected_action);
+    ui[3] = (uint8_t) selected_difficulty;
+    link_put32(link_put32(&payload[LINK_TM_BOARD], board.mask[0]), board.mask[1]);
+    payload[LINK_TM_FLAGS] = (uint8_t)(idle_mode | (current_player == 1) << 1 |
+                                       (trace_mode == TRACE_RECORDING) << 2 |
+                                       (trace_mode == TRACE_REPLAYING) << 3);
+    link_put32(&payload[LINK_TM_TX_DROPPED], usb_link.stats.tx_dropped);
+    link_put32(&payload[LINK_TM_RX_ERRORS], usb_link.stats.rx_errors);
+
+    if (tud_cdc_connected())
+        link_send(&usb_link, LINK_TELEMETRY, payload, sizeof(payload));
+}
+
+#if PROF_ENABLED
+static void link_send_profile(void) {
+    for (int i = 0; i < PROF_COUNT; i++) {
+        const prof_section_t *section = &prof[i];
+        uint8_t payload[LINK_PAYLOAD_MAX] = {0};
+        payload[LINK_PF_ID] = (uint8_t) i;
+        link_put32(&payload[LINK_PF_COUNT], section->count);
+        link_put32(&payload[LINK_PF_MIN], section->min_us);
+        link_put32(&payload[LINK_PF_MAX], section->max_us);
+        link_put32(link_put32(&payload[LINK_PF_TOTAL], (uint32_t) section->total_us),
+                   (uint32_t)(section->total_us >> 32));
+        for (int b = 0; b < PROF_BUCKETS; b++)
+            link_put32(&payload[LINK_PF_HIST + 4 * b], section->hist[b]);
+        strncpy((char *) &payload[LINK_PF_NAME], section->name, LINK_PAYLOAD_MAX - LINK_PF_NAME - 1);
+        link_send(&usb_link, LINK_PROFILE, payload, sizeof(payload));
+    }
+}
+#endif
+
+sched_task_t trace_tx_task;
+uint32_t trace_tx_offset;
+
+/**
+ * Envia o traço gravado em quadros LINK_TRACE à medida que o anel de saída
+ * tem espaço, terminando com um quadro vazio.
+ */
+static void link_send_trace(void *arg) {
+    while (link_ring_free(&usb_link.tx) >= LINK_WIRE_MAX) {
+        uint8_t payload[LINK_PAYLOAD_MAX];
+        uint32_t n = trace_writer.len - trace_tx_offset;
+        if (n > LINK_TRACE_CHUNK)
+            n = LINK_TRACE_CHUNK;
+        link_put16(payload, (uint16_t) trace_tx_offset);
+        memcpy(&payload[2], &trace_buffer[trace_tx_offset], n);
+        link_send(&usb_link, LINK_TRACE, payload, n + 2);
+        trace_tx_offset += n;
+        if (n == 0)
+            return;
+    }
+    sched_after_ms(&trace_tx_task, LINK_TX_RETRY_MS, link_send_trace, NULL);
+}
+
+static uint8_t link_trace_command(const uint8_t *arg, uint32_t len) {
+    if (len < 1)
+        return LINK_BAD_ARGUMENT;
+    // O buffer é um só: nada muda enquanto o traço é enviado.
+    if (sched_pending(&trace_tx_task))
+        return LINK_BUSY;
+    switch (arg[0]) {
+    case LINK_TRACE_RECORD:
+        return trace_record() ? LINK_OK : LINK_BUSY;
+    case LINK_TRACE_STOP:
+        if (trace_mode == TRACE_REPLAYING)
+            return LINK_BUSY;
+        if (trace_writer.data == NULL)
+            return LINK_BAD_ARGUMENT;
+        trace_mode = TRACE_IDLE;
+        trace_tx_offset = 0;
+        // Começa depois do ACK.
+        sched_after_ms(&trace_tx_task, 0, link_send_trace, NULL);
+        return LINK_OK;
+    case LINK_TRACE_LOAD: {
+        if (trace_mode != TRACE_IDLE)
+            return LINK_BUSY;
+        uint32_t offset = len >= 3 ? link_get16(&arg[1]) : UINT32_MAX;
+        uint32_t n = len - 3;
+        if (offset > sizeof(trace_buffer) || n > sizeof(trace_buffer) - offset)
+            return LINK_BAD_ARGUMENT;
+        memcpy(&trace_buffer[offset], &arg[3], n);
+        if (offset == 0)
+            trace_loaded = 0;
+        if (offset + n > trace_loaded)
+            trace_loaded = offset + n;
+        trace_writer.data = NULL;           // A gravação anterior foi sobrescrita
+        return LINK_OK;
+    }
+    case LINK_TRACE_PLAY:
+        if (trace_mode != TRACE_IDLE || ui_state != UI_MAIN)
+            return LINK_BUSY;
+        return trace_play() ? LINK_OK : LINK_BAD_ARGUMENT;
+    default:
+        return LINK_BAD_ARGUMENT;
+    }
+}
+
+sched_task_t history_tx_task;
+uint32_t history_tx_offset;           // Posição na imagem exportada
+uint32_t history_tx_tail;             // Posição no anel do primeiro registro
+
+/**
+ * Envia a imagem do histórico (cabeçalho e registros, inc/hist.h) em quadros
+ * LINK_HISTORY, terminando com um quadro vazio. O anel continua recebendo
+ * registros; se descartar um trecho ainda não enviado, a exportação
+ * recomeça da posição 0.
+ */
+static void link_send_history(void *arg) {
+    while (link_ring_free(&usb_link.tx) >= LINK_WIRE_MAX) {
+        uint8_t payload[LINK_PAYLOAD_MAX];
+        int n;
+        if (history_tx_offset == 0) {
+            history_tx_tail = history.tail;
+            n = (int) hist_export_header(&history, (uint32_t)(uptime_ms() / 1000), &payload[2]);
+        } else {
+            n = hist_copy(&history, history_tx_tail + history_tx_offset - HIST_HEADER_LEN,
+                          &payload[2], LINK_HISTORY_CHUNK);
+            if (n < 0) {
+                history_tx_offset = 0;
+                continue;
+            }
+        }
+        link_put16(payload, (uint16_t) history_tx_offset);
+        link_send(&usb_link, LINK_HISTORY, payload, (uint32_t) n + 2);
+        history_tx_offset += (uint32_t) n;
+        if (n == 0)
+            return;
+    }
+    sched_after_ms(&history_tx_task, LINK_TX_RETRY_MS, link_send_history, NULL);
+}
+
+/**
+ * Executa um comando do PC e responde com LINK_ACK. Durante a reprodução de
+ * um traço, os comandos que mudam o Bob ou a interface ficam de fora.
+ */
+static void link_command(const link_frame_t *frame) {
+    const uint8_t *arg = frame->payload;
+    uint8_t result = LINK_OK;
+    bool replaying = trace_mode == TRACE_REPLAYING;
+    switch (frame->type) {
+    case LINK_CMD_RATE:
+        if (frame->len < 2) {
+            result = LINK_BAD_ARGUMENT;
+        } else if (link_get16(arg) == 0) {
+            sched_cancel(&telemetry_task);
+        } else {
+            sched_every_ms(&telemetry_task, link_get16(arg), telemetry_tick, NULL);
+        }
+        break;
+    case LINK_CMD_SET_STAT: {
+        if (frame->len < 2 || arg[0] >= PET_STATS || arg[1] > PET_MAX) {
+            result = LINK_BAD_ARGUMENT;
+            break;
+        }
+        if (replaying) {
+            result = LINK_BUSY;
+            break;
+        }
+        uint64_t now_ms = uptime_ms();
+        pet_view_t view;
+        pet_shared_view(&bob, now_ms, &view);
+        int8_t delta[PET_STATS] = {0};
+        delta[arg[0]] = (int8_t)(arg[1] - pet_view_get(&view, (pet_stat_t) arg[0]));
+        history_note(HIST_DECAY);
+        pet_shared_apply(&bob, delta, now_ms);
+        history_note(HIST_CHANGE);
+        bob_save();
+        ui_render();
+        break;
+    }
+    case LINK_CMD_INPUT:
+        if (frame->len < 1 || arg[0] == INPUT_NONE || arg[0] > INPUT_BACK)
+            result = LINK_BAD_ARGUMENT;
+        else if (replaying || !input_queue_push(&link_queue, (input_t) arg[0], INPUT_SRC_LINK, time_us_32()))
+            result = LINK_BUSY;
+        break;
+    case LINK_CMD_ACTION: {
+        const menu_t *menu = frame->len < 2 ? NULL : arg[0] == 0 ? &main_menu :
+                             arg[0] == 1 ? &food_menu : arg[0] == 2 ? &play_menu : NULL;
+        if (menu == NULL || arg[1] >= menu->count) {
+            result = LINK_BAD_ARGUMENT;
+        } else if (replaying || (ui_state != UI_MAIN && ui_state != UI_SUBMENU)) {
+            // Mensagens, partidas e animações não são interrompidas.
+            result = LINK_BUSY;
+        } else {
+            idle_note_input();
+            action_select(&menu->items[arg[1]]);
+            bob_save();
+            ui_render();
+        }
+        break;
+    }
+    case LINK_CMD_PROFILE:
+#if PROF_ENABLED
+        if (frame->len >= 1 && arg[0] == 1) {
+            for (int i = 0; i < PROF_COUNT; i++)
+                prof_reset(&prof[i]);
+        } else {
+            link_send_profile();
+        }
+#else
+        result = LINK_BAD_COMMAND;
+#endif
+        break;
+    case LINK_CMD_TRACE:
+        result = link_trace_command(arg, frame->len);
+        break;
+    case LINK_CMD_HISTORY:
+        if (sched_pending(&history_tx_task)) {
+            result = LINK_BUSY;
+            break;
+        }
+        history_tx_offset = 0;
+        // Começa depois do ACK.
+        sched_after_ms(&history_tx_task, 0, link_send_history, NULL);
+        break;
+    default:
+        result = LINK_BAD_COMMAND;
+        break;
+    }
+    uint8_t ack[3] = {frame->seq, frame->type, result};
+    link_send(&usb_link, LINK_ACK, ack, sizeof(ack));
+}
+
+/**
+ * Recebe e executa os comandos pendentes e envia o que houver no anel.
+ */
+void link_service(void) {
+    tud_task();
+    uint8_t chunk[64];
+    uint32_t n;
+    link_frame_t frame;
+    // Executar os comandos esvazia o anel de entrada; repete enquanto o FIFO
+    // do CDC tiver bytes, porque nenhuma interrupção avisará deles de novo.
+    do {
+        while (link_ring_free(&usb_link.rx) >= sizeof(chunk) &&
+               (n = tud_cdc_read(chunk, sizeof(chunk))) > 0)
+            link_ring_write(&usb_link.rx, chunk, n);
+        while (link_receive(&usb_link, &frame))
+            link_command(&frame);
+    } while (tud_cdc_available() > 0);
+    if (link_ring_used(&usb_link.tx) > 0 && !sched_pending(&link_tx_task))
+        link_flush(NULL);
+}
+
+void link_init_usb(void) {
+    link_init(&usb_link);
+    input_queue_init(&link_queue);
+    input_queue_init(&trace_queue);
+    if (!input_attach(&link_queue) || !input_attach(&trace_queue))
+        panic("input: filas demais");
+    tusb_init();
+}
+
+// ---------------------- Função Principal ----------------------
+int main() {
+    stdio_init_all();                   // UART: mensagens de panic
+    srand((unsigned) to_ms_since_boot(get_absolute_time()));
+
+    pet_shared_init(&bob, bob_initial_q8, DECAY_INTERVAL_MS);
+    mnk_engine_init(&game_engine);
+
+    // Configuração dos LEDs externos
+    gpio_init(RED_LED_PIN);
+    gpio_set_dir(RED_LED_PIN, GPIO_OUT);
+    gpio_put(RED_LED_PIN, 0);
+    gpio_init(GREEN_LED_PIN);
+    gpio_set_dir(GREEN_LED_PIN, GPIO_OUT);
+    gpio_put(GREEN_LED_PIN, 0);
+
+    // Inicializa a amostragem do joystick (ADC + DMA)
+    joystick_sampler_init();
+
+    // Configura os botões
+    buttons_init();
+
+    // Inicializa o buzzer via PWM
+    pwm_init_buzzer(BUZZER_PIN);
+
+    // A matriz de LEDs e o OLED (i2c1) são inicializados e servidos pelo núcleo 1.
+    led_map_init();
+    calculate_render_area_buffer_length(&frame_area);
+    multicore_launch_core1(render_core_main);
+
+    // Sem sessão salva, começa pelo seletor de dificuldade; o decaimento
+    // inicia após a escolha. O histórico parte do estado restaurado.
+    bool restored = store_load();
+    history_init();
+    if (restored) {
+        difficulty_confirmed();
+    } else {
+        ui_state = UI_DIFFICULTY;
+        ui_render();
+    }
+
+    sched_every_ms(&render_task, RENDER_MS, render_tick, NULL);
+    sched_after_ms(&idle_task, IDLE_TIMEOUT_MS, idle_enter, NULL);
+    sched_every_ms(&power_report_task, POWER_REPORT_MS, power_report_tick, NULL);
+    link_init_usb();
+
+    // Laço de eventos: entrega a entrada, executa as tarefas vencidas, publica
+    // o quadro desenhado e dorme até o próximo prazo ou interrupção.
+    while (true) {
+        PROF_BEGIN(start);
+        input_dispatch();
+        sched_run();
+        render_commit();
+        PROF_END(&prof[PROF_LOOP], start);
+        link_service();
+        sched_wait();
+    }
+
+    return 0;
+}
@@ -0,0 +1,17 @@
+#ifndef TUSB_CONFIG_H
+#define TUSB_CONFIG_H
+
+// ---------------------- Configuração do TinyUSB ----------------------
+// Dispositivo com uma única interface CDC, usado no lugar do stdio USB do
+// pico-sdk (ver "Telemetria pela USB" em tamagotchi.c). O TinyUSB inclui
+// este arquivo pelo nome; MCU e sistema operacional vêm do pico-sdk.
+
+#define CFG_TUSB_RHPORT0_MODE   OPT_MODE_DEVICE
+#define CFG_TUD_ENDPOINT0_SIZE  64
+
+#define CFG_TUD_CDC             1
+#define CFG_TUD_CDC_RX_BUFSIZE  256     // FIFOs do CDC, como no stdio USB
+#define CFG_TUD_CDC_TX_BUFSIZE  256
+#define CFG_TUD_CDC_EP_BUFSIZE  64
+
+#endif
@@ -0,0 +1,84 @@
+#include "pico/stdlib.h"
+#include "pico/unique_id.h"
+#include "tusb.h"
+
+// ---------------------- Descritores da USB ----------------------
+// Uma serial CDC com o VID da Raspberry Pi e o PID do stdio USB do pico-sdk,
+// para o PC enxergar a mesma porta de antes. O número de série é o ID único
+// da flash.
+#define USB_VID           0x2E8A
+#define USB_PID           0x000A
+#define USB_CDC_EP_NOTIF  0x81
+#define USB_CDC_EP_OUT    0x02
+#define USB_CDC_EP_IN     0x82
+#define USB_CONFIG_LEN    (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN)
+
+enum { USB_ITF_CDC = 0, USB_ITF_CDC_DATA, USB_ITF_COUNT };
+enum { USB_STR_LANGUAGE = 0, USB_STR_MANUFACTURER, USB_STR_PRODUCT, USB_STR_SERIAL,
+       USB_STR_CDC, USB_STR_COUNT };
+
+static const tusb_desc_device_t usb_device = {
+    .bLength = sizeof(tusb_desc_device_t),
+    .bDescriptorType = TUSB_DESC_DEVICE,
+    .bcdUSB = 0x0200,
+    // O CDC tem duas interfaces, agrupadas por um IAD.
+    .bDeviceClass = TUSB_CLASS_MISC,
+    .bDeviceSubClass = MISC_SUBCLASS_COMMON,
+    .bDeviceProtocol = MISC_PROTOCOL_IAD,
+    .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor = USB_VID,
+    .idProduct = USB_PID,
+    .bcdDevice = 0x0100,
+    .iManufacturer = USB_STR_MANUFACTURER,
+    .iProduct = USB_STR_PRODUCT,
+    .iSerialNumber = USB_STR_SERIAL,
+    .bNumConfigurations = 1,
+};
+
+static const uint8_t usb_config[USB_CONFIG_LEN] = {
+    TUD_CONFIG_DESCRIPTOR(1, USB_ITF_COUNT, 0, USB_CONFIG_LEN, 0, 100),
+    TUD_CDC_DESCRIPTOR(USB_ITF_CDC, USB_STR_CDC, USB_CDC_EP_NOTIF, 8, USB_CDC_EP_OUT,
+                       USB_CDC_EP_IN, CFG_TUD_CDC_EP_BUFSIZE),
+};
+
+static const char *const usb_strings[USB_STR_COUNT] = {
+    [USB_STR_MANUFACTURER] = "Raspberry Pi",
+    [USB_STR_PRODUCT] = "Bob",
+    [USB_STR_CDC] = "Bob",
+};
+
+const uint8_t *tud_descriptor_device_cb(void) {
+    return (const uint8_t *) &usb_device;
+}
+
+const uint8_t *tud_descriptor_configuration_cb(uint8_t index) {
+    return usb_config;
+}
+
+/**
+ * Converte a string pedida para UTF-16 num buffer estático, como o TinyUSB
+ * espera; o índice 0 é a lista de idiomas (só inglês dos EUA).
+ */
+const uint16_t *tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+    static uint16_t desc[1 + 2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES];
+    char serial[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+    uint len = 0;
+    if (index == USB_STR_LANGUAGE) {
+        desc[1] = 0x0409;
+        len = 1;
+    } else if (index < USB_STR_COUNT) {
+        const char *text = usb_strings[index];
+        if (index == USB_STR_SERIAL) {
+            pico_get_unique_board_id_string(serial, sizeof(serial));
+            text = serial;
+        }
+        while (len < count_of(desc) - 1 && text[len] != '\0') {
+            desc[1 + len] = (uint8_t) text[len];
+            len++;
+        }
+    } else {
+        return NULL;
+    }
+    desc[0] = (uint16_t)(TUSB_DESC_STRING << 8 | (2 * len + 2));
+    return desc;
+}